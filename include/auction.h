@@ -4,6 +4,8 @@
 #include "data_structures.h"
 
 
-void run_part4_vcg_auction(graph *g, unsigned char *security_set);
+/* order may be NULL. Otherwise g is the relabelled graph: bids and the
+ * endpoints are drawn per original id and all output uses original ids. */
+void run_part4_vcg_auction(graph *g, unsigned char *security_set, const graph_order *order);
 
 #endif
\ No newline at end of file
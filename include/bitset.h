@@ -0,0 +1,64 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "data_structures.h"
+
+/*
+ * Packed node sets: bit i of word i/64 is node i. Used as the strategy
+ * profile of game_system and for coalition checks, cutting the working
+ * set of the random neighbour gathers by 8x compared to one byte per node.
+ */
+
+#define BITSET_WORDS(n) (((size_t)(n) + 63) / 64)
+
+static inline int bitset_test(const uint64_t *bits, int i)
+{
+    return (int)((bits[i >> 6] >> (i & 63)) & 1);
+}
+
+static inline void bitset_set(uint64_t *bits, int i)
+{
+    bits[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+
+static inline void bitset_clear(uint64_t *bits, int i)
+{
+    bits[i >> 6] &= ~((uint64_t)1 << (i & 63));
+}
+
+static inline void bitset_assign(uint64_t *bits, int i, int value)
+{
+    if (value)
+        bitset_set(bits, i);
+    else
+        bitset_clear(bits, i);
+}
+
+/* For bitsets whose words are updated concurrently by other threads. */
+static inline int bitset_test_relaxed(const uint64_t *bits, int i)
+{
+    return (int)((__atomic_load_n(&bits[i >> 6], __ATOMIC_RELAXED) >> (i & 63)) & 1);
+}
+
+static inline void bitset_assign_atomic(uint64_t *bits, int i, int value)
+{
+    uint64_t mask = (uint64_t)1 << (i & 63);
+    if (value)
+        __atomic_fetch_or(&bits[i >> 6], mask, __ATOMIC_RELAXED);
+    else
+        __atomic_fetch_and(&bits[i >> 6], ~mask, __ATOMIC_RELAXED);
+}
+
+uint64_t *bitset_create(int num_bits);
+uint64_t *bitset_from_bytes(const unsigned char *bytes, int num_bits);
+uint64_t *bitset_from_list(const int *items, size_t count, int num_bits);
+unsigned char *bitset_to_bytes(const uint64_t *bits, int num_bits);
+
+size_t bitset_count(const uint64_t *bits, int num_bits);
+int bitset_count_row(graph *g, int node, const uint64_t *bits);
+int bitset_is_valid_cover(graph *g, const uint64_t *bits);
+int bitset_is_minimal(graph *g, const uint64_t *bits);
+
+#endif
@@ -8,11 +8,18 @@ double characteristic_function_v1(graph *g, int *coalition, size_t coalition_siz
 double characteristic_function_v2(graph *g, int *coalition, size_t coalition_size);
 double characteristic_function_v3(graph *g, int *coalition, size_t coalition_size);
 
-double* calculate_shapley_values(graph *g, int iterations, int version);
+#define SHAPLEY_AUTO 0
+#define SHAPLEY_EXACT 1
+#define SHAPLEY_MONTE_CARLO 2
+#define SHAPLEY_MONTE_CARLO_SCALAR 3
+#define SHAPLEY_LOCAL 4
+
+double* calculate_shapley_values(graph *g, int iterations, int version, int method,
+                                 double ci_width, int top_k);
 
 unsigned char* build_security_set_from_shapley(graph *g, double *shapley_values);
 
-int count_covered_edges(graph *g, int *coalition, size_t coalition_size);
+eidx_t count_covered_edges(graph *g, int *coalition, size_t coalition_size);
 int is_coalition_valid_cover(graph *g, int *coalition, size_t coalition_size);
 int is_coalition_minimal(graph *g, int *coalition, size_t coalition_size);
 
@@ -1,21 +1,64 @@
 #ifndef DATA_STRUCTURES_H
 #define DATA_STRUCTURES_H
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
 
 #define COST_SECURITY       1.0
 #define PENALTY_UNSECURED   10.0
 
+/*
+ * Type of CSR offsets and edge counts. The default build keeps them 32-bit;
+ * WIDE=1 (-DGRAPH_WIDE_INDEX) widens them to 64 bits for graphs past 2^31
+ * directed edges. Node ids and col_ind stay 32-bit in both builds.
+ */
+#ifdef GRAPH_WIDE_INDEX
+typedef int64_t eidx_t;
+#define EIDX_MAX INT64_MAX
+#define PRIeidx PRId64
+#else
+typedef int eidx_t;
+#define EIDX_MAX INT32_MAX
+#define PRIeidx "d"
+#endif
 
 typedef struct
 {
     int num_nodes;
-    int num_edges;
-    int *row_ptr;
+    eidx_t num_edges;
+    eidx_t *row_ptr;
     int *col_ind;
+    void *mapping;
+    size_t mapping_size;
 } graph;
 
+/*
+ * Binary CSR file: this header, then row_ptr and col_ind, each starting
+ * on a GRAPH_FILE_ALIGN boundary so the file can be mapped and used in
+ * place. Integers are stored in the writer's byte order; endian_tag lets
+ * a reader detect a mismatch.
+ */
+#define GRAPH_FILE_MAGIC "CSRGRAPH"
+#define GRAPH_FILE_VERSION 1
+#define GRAPH_FILE_ENDIAN_TAG 0x01020304u
+#define GRAPH_FILE_ALIGN 64
+#define GRAPH_STREAM_WINDOW_BYTES ((size_t)256 << 20)
+
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t endian_tag;
+    uint32_t offset_bytes;
+    uint32_t node_bytes;
+    uint64_t num_nodes;
+    uint64_t num_edges;
+    uint64_t row_ptr_offset;
+    uint64_t col_ind_offset;
+    uint8_t reserved[8];
+} graph_file_header;
+
 
 typedef struct {
     int id;
@@ -44,47 +87,129 @@ typedef struct {
 
 typedef struct
 {
-    double *regrets;
-    double *probs;
+    double *regret_out;
+    double *regret_in;
+    double *prob_in;
+    unsigned char *samples;
+    uint64_t seed;
+    long round;
 } regret_system;
 
+/* believes has num_players + 1 entries; the last one stays 1.0 and is the
+ * padding target of the SELL-C-sigma layout. */
 typedef struct
 {
     int *counts;
     double *believes;
+    unsigned char *next_strategies;
+    int deterministic;
     int turn;
 } fictitious_system;
 
 
+typedef struct
+{
+    int num_colors;
+    int *color;
+    int *class_ptr;
+    int *class_nodes;
+} graph_coloring;
+
+/*
+ * SELL-C-sigma copy of the adjacency: rows are sorted by decreasing degree
+ * within windows of sigma rows, then cut into chunks of chunk_size rows.
+ * Each chunk is stored column-major and padded to its longest row, so
+ * entry j of the row in slot s is col_ind[chunk_ptr[s / C] + j * C + s % C].
+ * Padding entries and the rows of the last chunk past num_rows point at
+ * column num_rows; perm maps a slot to its row, or -1 for such rows.
+ */
+typedef struct
+{
+    int chunk_size;
+    int sigma;
+    int num_rows;
+    int num_chunks;
+    int *perm;
+    eidx_t *chunk_ptr;
+    int *col_ind;
+} sell_matrix;
+
+/* A relabelling of the nodes: new_id[old] and its inverse old_id[new]. */
+typedef struct
+{
+    int num_nodes;
+    int *new_id;
+    int *old_id;
+} graph_order;
+
+typedef struct
+{
+    long uncovered_edges;
+    int redundant_secured;
+} game_counter_delta;
+
+
 typedef struct
 {
     graph *g;
-    unsigned char *strategies;
+
+    /* Strategy profile, one bit per node (set = secured). This is the only
+     * copy; bitset_to_bytes() exports it for the market and the auction. */
+    uint64_t *strategy_bits;
     
     regret_system rs;
     
     fictitious_system fs;
 
+    /* Kept in sync by game_set_strategy(): number of unsecured neighbours of
+     * each node, edges with both endpoints unsecured, and secured nodes with
+     * no private edge (all neighbours secured). */
+    int *unsecured_neighbors;
+    long uncovered_edges;
+    int redundant_secured;
+
+    graph_coloring *coloring;
+    sell_matrix *sell;
+
+    /* Relabelling applied to g (NULL if none). Per-node random draws and
+     * the log use the original ids, so -R only changes the layout. */
+    const graph_order *order;
+    int *partition;
+    int num_parts;
+
     int num_players;
     int iteration;
 } game_system;
 
 
-graph* create_graph(int num_nodes, int num_edges);
+graph* create_graph(int num_nodes, eidx_t num_edges);
 void free_graph(graph *g);
 void print_graph(graph *g);
 
+void graph_file_header_init(graph_file_header *h, uint64_t num_nodes, uint64_t num_edges);
 graph* load_graph_from_file(const char *filename);
 int save_graph_to_file(graph *g, const char *filename);
+char *graph_temp_path(const char *filename);
+int convert_text_to_binary(const char *text_file, const char *binary_file, size_t window_bytes);
+int is_binary_graph_file(const char *filename);
+graph* load_graph(const char *filename);
 graph* load_graph_from_text(const char *filename);
 int save_graph_to_text(graph *g, const char *filename);
 
 graph* generate_random_regular(int num_nodes, int degree);
 graph* generate_erdos_renyi(int num_nodes, double p);
 graph* generate_barabasi_albert(int num_nodes, int m);
+graph* generate_rmat(int num_nodes, eidx_t num_edges);
+graph* generate_watts_strogatz(int num_nodes, int k, double beta);
+void sort_adjacency(int *row, int len);
 
-void init_game(game_system *game, graph *g); 
+void init_game(game_system *game, graph *g, const graph_order *order);
 void free_game(game_system *game);
+void game_set_strategy(game_system *game, int player_id, unsigned char strategy);
+void game_set_strategy_concurrent(game_system *game, int player_id, unsigned char strategy,
+                                  game_counter_delta *delta);
+void game_refresh_counters(game_system *game);
+void game_assign_strategies(game_system *game, const unsigned char *strategies);
 
 
 min_heap* create_heap(int capacity);
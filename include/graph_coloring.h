@@ -0,0 +1,9 @@
+#ifndef GRAPH_COLORING_H
+#define GRAPH_COLORING_H
+
+#include "data_structures.h"
+
+graph_coloring *compute_graph_coloring(graph *g);
+void free_graph_coloring(graph_coloring *c);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef GRAPH_REORDER_H
+#define GRAPH_REORDER_H
+
+#include "data_structures.h"
+
+/*
+ * Node relabelling for locality. The engines read neighbour state through
+ * col_ind gathers, so an order that places adjacent nodes on nearby ids
+ * keeps those gathers in cache. The graph is permuted once before solving;
+ * anything reported by node id is translated back with graph_order_original().
+ */
+
+#define REORDER_NONE 0
+#define REORDER_DEGREE 1
+#define REORDER_RCM 2
+#define REORDER_GORDER 3
+
+int parse_reorder_method(const char *name);
+const char *reorder_method_name(int method);
+
+graph_order *compute_graph_order(graph *g, int method);
+graph *apply_graph_order(graph *g, const graph_order *order);
+void free_graph_order(graph_order *order);
+double mean_neighbor_distance(graph *g);
+
+static inline int graph_order_original(const graph_order *order, int v)
+{
+    return order ? order->old_id[v] : v;
+}
+
+static inline int graph_order_relabel(const graph_order *order, int v)
+{
+    return order ? order->new_id[v] : v;
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "data_structures.h"
+
+/*
+ * Persistent worker pool. parallel_run() executes the task once on every
+ * thread (the caller acts as thread 0) and returns when all have finished.
+ * With a single thread the task is simply called inline. parallel_barrier()
+ * may only be called from inside a task, by every thread of the pool.
+ */
+
+typedef void (*parallel_task)(int thread_id, int num_threads, void *arg);
+
+void parallel_init(int num_threads);
+void parallel_shutdown(void);
+int parallel_num_threads(void);
+
+void parallel_run(parallel_task task, void *arg);
+void parallel_barrier(void);
+void parallel_block(long n, int thread_id, int num_threads, long *begin, long *end);
+void parallel_partition_by_edges(graph *g, int num_parts, int *bounds);
+
+#endif
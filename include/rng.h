@@ -0,0 +1,101 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/*
+ * Every random decision in the program derives from a single global seed
+ * (rng_set_seed, set from -s). Each subsystem owns a stream identified by
+ * an rng_stream_id plus an index, so adding draws in one subsystem never
+ * shifts the numbers seen by another.
+ *
+ * Two flavours are provided:
+ *  - rng_state: xoshiro256** for sequential consumers (generators,
+ *    shuffles). rng_jump() advances 2^128 steps to split off
+ *    non-overlapping substreams.
+ *  - rng_counter: draw number `counter` of the stream identified by `key`
+ *    is a pure function of both, so any thread can produce it without
+ *    shared state and results do not depend on how work is split.
+ */
+
+typedef enum
+{
+    RNG_STREAM_GRAPH,
+    RNG_STREAM_GAME,
+    RNG_STREAM_REGRET,
+    RNG_STREAM_FICTITIOUS,
+    RNG_STREAM_SHAPLEY,
+    RNG_STREAM_MARKET,
+    RNG_STREAM_AUCTION
+} rng_stream_id;
+
+typedef struct
+{
+    uint64_t s[4];
+} rng_state;
+
+void rng_set_seed(uint64_t seed);
+uint64_t rng_get_seed(void);
+uint64_t rng_stream_key(rng_stream_id stream, uint64_t index);
+
+void rng_init(rng_state *st, rng_stream_id stream, uint64_t index);
+void rng_jump(rng_state *st);
+
+static inline uint64_t rng_rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t rng_next(rng_state *st)
+{
+    uint64_t *s = st->s;
+    uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rng_rotl(s[3], 45);
+
+    return result;
+}
+
+static inline double rng_next_double(rng_state *st)
+{
+    return (double)(rng_next(st) >> 11) * 0x1.0p-53;
+}
+
+/* Uniform integer in [0, bound) for bound < 2^32 (multiply-shift). */
+static inline uint32_t rng_next_bounded(rng_state *st, uint32_t bound)
+{
+    return (uint32_t)(((rng_next(st) >> 32) * (uint64_t)bound) >> 32);
+}
+
+/* Any 64-bit bound; draws the same values as rng_next_bounded() below 2^32. */
+static inline uint64_t rng_next_bounded64(rng_state *st, uint64_t bound)
+{
+    if (bound <= UINT32_MAX)
+        return rng_next_bounded(st, (uint32_t)bound);
+    return (uint64_t)(((unsigned __int128)rng_next(st) * bound) >> 64);
+}
+
+static inline uint64_t rng_mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rng_counter(uint64_t key, uint64_t counter)
+{
+    return rng_mix64(key ^ rng_mix64(counter + 0x9E3779B97F4A7C15ULL));
+}
+
+static inline double rng_counter_double(uint64_t key, uint64_t counter)
+{
+    return (double)(rng_counter(key, counter) >> 11) * 0x1.0p-53;
+}
+
+#endif
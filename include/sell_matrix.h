@@ -0,0 +1,23 @@
+#ifndef SELL_MATRIX_H
+#define SELL_MATRIX_H
+
+#include "data_structures.h"
+
+/*
+ * SELL-C-sigma adjacency for the Fictitious Play expected-utility kernel.
+ * The FP loop is a sparse matrix-vector product over the beliefs; in CSR
+ * form its inner loop runs over one row of irregular length, while here C
+ * rows of similar length advance together, one SIMD lane per row.
+ */
+
+sell_matrix *build_sell_matrix(graph *g, int chunk_size, int sigma);
+void free_sell_matrix(sell_matrix *s);
+void sell_partition(const sell_matrix *s, int part, int num_parts, int *begin, int *end);
+
+/* out[lane] = sum over the neighbours v of the row in that slot of
+ * -PENALTY_UNSECURED * (1 - believes[v]), accumulated in row order, for
+ * every slot of the chunk. believes needs num_rows + 1 entries with 1.0
+ * in the last one. */
+void sell_unsecured_penalty(const sell_matrix *s, int chunk, const double *believes, double *out);
+
+#endif
@@ -8,6 +8,8 @@
 #define ALGO_RM  2
 #define ALGO_FP  3
 #define ALGO_FP_ASYNC 5
+#define ALGO_BRD_WORKLIST 6
+#define ALGO_BRD_COLORED 7
 
 double calculate_utility(game_system *game, int player_id, int strategy);
 
@@ -15,10 +17,17 @@ int run_simulation(game_system *game, int algorithm, int max_it, int verbose);
 int run_simulation_with_restart(game_system *game, int algorithm, int max_it, int verbose, int restart_interval);
 
 int run_best_response_iteration(game_system *game);
+int run_best_response_worklist(game_system *game, int max_it, int verbose);
+int run_best_response_colored_iteration(game_system *game);
 int run_regret_matching_iteration(game_system *game);
+int run_regret_matching_iteration_parallel(game_system *game);
+void regret_matching_sample(game_system *game, uint64_t round_key, int begin, int end);
+int regret_matching_update(game_system *game, int begin, int end);
 
 int run_fictitious_play_iteration(game_system *game);
+int run_fictitious_play_iteration_parallel(game_system *game);
 int run_async_fictitious_play_iteration(game_system *game);
+int run_async_fictitious_play_iteration_parallel(game_system *game);
 
 int is_valid_cover(game_system *game);
 int is_minimal(game_system *game);
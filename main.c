@@ -6,30 +6,54 @@
 #include <string.h>
 #include "include/algorithm.h"
 #include "include/data_structures.h"
+#include "include/graph_reorder.h"
+#include "include/sell_matrix.h"
+#include "include/bitset.h"
 #include "include/min_cost_flow.h"
 #include "include/auction.h"
 #include "include/logging.h"
+#include "include/parallel.h"
+#include "include/rng.h"
 
 #define GRAPH_FILENAME "graph.txt"
 
 #define TYPE_REGULAR 0
 #define TYPE_ERDOS 1
 #define TYPE_BARABASI 2
+#define TYPE_RMAT 3
+#define TYPE_WATTS_STROGATZ 4
 
 #define ALGO_SHAPLEY 4
 
+static double wall_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
 void print_usage(const char *prog_name)
 {
     printf("Usage: %s [options]\n", prog_name);
     printf("Options:\n");
     printf("  -n <nodes>       Number of nodes (default: 10000)\n");
-    printf("  -k <val>         Degree/Param (Reg: degree, ER: avg degree, BA: m) (default: 4)\n");
-    printf("  -t <type>        Graph Type (0=Regular, 1=Erdos, 2=Barabasi) (default: 0)\n");
+    printf("  -k <val>         Degree/Param (Reg: degree, ER/R-MAT: avg degree, BA: m, WS: ring degree) (default: 4)\n");
+    printf("  -t <type>        Graph Type (0=Regular, 1=Erdos, 2=Barabasi, 3=R-MAT, 4=Watts-Strogatz) (default: 0)\n");
+    printf("  -p <beta>        Watts-Strogatz rewiring probability (default: 0.1)\n");
     printf("  -i <iterations>  Maximum number of iterations (default: 10000)\n");
-    printf("  -a <algorithm>   Algorithm to use (1=BRD, 2=RM, 3=FP, 4=Shapley, 5=FP_Async) (default: 3)\n");
+    printf("  -a <algorithm>   Algorithm to use (1=BRD, 2=RM, 3=FP, 4=Shapley, 5=FP_Async,\n                   6=BRD_Worklist, 7=BRD_Colored) (default: 3)\n");
     printf("  -v <version>     Characteristic function version for Shapley (1, 2, or 3) (default: 3)\n");
+    printf("  -m <method>      Shapley method (auto, exact, mc, mc-scalar, local) (default: auto)\n");
+    printf("  -e <width>       Adaptive Shapley: stop at this 95%% CI half-width (-i is the budget)\n");
+    printf("  -r <k>           Adaptive Shapley: stop once the top-k nodes are stable\n");
     printf("  -c <capacity>    Capacity Mode (0=Infinite, 1=Limited, 2=Both) (default: 0)\n");
-    printf("  -f <file>        Load graph from file instead of generating one\n");
+    printf("  -f <file>        Load graph from file instead of generating one (text or binary CSR)\n");
+    printf("  -o <file>        Also write the graph as a binary CSR file (fast to load with -f)\n");
+    printf("  -R <order>       Relabel nodes for locality before solving (none, degree, rcm, gorder) (default: none)\n");
+    printf("  -j <threads>     Number of worker threads for parallel engines (default: 1)\n");
+    printf("  -d               Deterministic (colour-epoch) mode for parallel FP_Async\n");
+    printf("  -S <C>[,<sigma>] SELL-C-sigma adjacency for the FP and FP_Async kernels (default: off, CSR)\n");
+    printf("  -s <seed>        Seed for all random streams (default: current time)\n");
     printf("  -h               Show this help message\n");
 }
 
@@ -41,12 +65,23 @@ int main(int argc, char *argv[])
     int max_it = 1000;
     int algorithm = ALGO_FP;
     int graph_type = TYPE_REGULAR;
-    int shapley_version = 4;
+    double rewire_prob = 0.1;
+    int shapley_version = 3;
+    int shapley_method = SHAPLEY_AUTO;
+    double shapley_ci_width = 0.0;
+    int shapley_top_k = 0;
     int capacity_mode = 0;
     char *input_file = NULL;
+    char *output_file = NULL;
+    int num_threads = 1;
+    int deterministic = 0;
+    int reorder_method = REORDER_NONE;
+    int sell_chunk = 0;
+    int sell_sigma = 1;
+    uint64_t seed = (uint64_t)time(NULL);
 
     int opt;
-    while ((opt = getopt(argc, argv, "n:k:i:a:t:v:c:f:h")) != -1)
+    while ((opt = getopt(argc, argv, "n:k:i:a:t:p:v:m:e:r:c:f:o:R:j:dS:s:h")) != -1)
     {
         switch (opt)
         {
@@ -58,9 +93,17 @@ int main(int argc, char *argv[])
             break;
         case 't':
             graph_type = atoi(optarg);
-            if (graph_type < 0 || graph_type > 2)
+            if (graph_type < 0 || graph_type > 4)
             {
-                fprintf(stderr, "Invalid graph type. Use 0, 1, or 2.\n");
+                fprintf(stderr, "Invalid graph type. Use 0 to 4.\n");
+                return 1;
+            }
+            break;
+        case 'p':
+            rewire_prob = atof(optarg);
+            if (rewire_prob < 0.0 || rewire_prob > 1.0)
+            {
+                fprintf(stderr, "Invalid rewiring probability. Use a value in [0, 1].\n");
                 return 1;
             }
             break;
@@ -69,9 +112,9 @@ int main(int argc, char *argv[])
             break;
         case 'a':
             algorithm = atoi(optarg);
-            if ((algorithm < ALGO_BRD || algorithm > ALGO_SHAPLEY) && algorithm != ALGO_FP_ASYNC)
+            if (algorithm < ALGO_BRD || algorithm > ALGO_BRD_COLORED)
             {
-                fprintf(stderr, "Invalid algorithm selection. Use 1, 2, 3, 4, or 5.\n");
+                fprintf(stderr, "Invalid algorithm selection. Use 1 to 7.\n");
                 return 1;
             }
             break;
@@ -83,6 +126,39 @@ int main(int argc, char *argv[])
                 return 1;
             }
             break;
+        case 'm':
+            if (strcmp(optarg, "auto") == 0)
+                shapley_method = SHAPLEY_AUTO;
+            else if (strcmp(optarg, "exact") == 0)
+                shapley_method = SHAPLEY_EXACT;
+            else if (strcmp(optarg, "mc") == 0)
+                shapley_method = SHAPLEY_MONTE_CARLO;
+            else if (strcmp(optarg, "mc-scalar") == 0)
+                shapley_method = SHAPLEY_MONTE_CARLO_SCALAR;
+            else if (strcmp(optarg, "local") == 0)
+                shapley_method = SHAPLEY_LOCAL;
+            else
+            {
+                fprintf(stderr, "Invalid Shapley method. Use auto, exact, mc, mc-scalar, or local.\n");
+                return 1;
+            }
+            break;
+        case 'e':
+            shapley_ci_width = atof(optarg);
+            if (shapley_ci_width <= 0.0)
+            {
+                fprintf(stderr, "Invalid CI width. Use a value > 0.\n");
+                return 1;
+            }
+            break;
+        case 'r':
+            shapley_top_k = atoi(optarg);
+            if (shapley_top_k < 1)
+            {
+                fprintf(stderr, "Invalid top-k. Use a value >= 1.\n");
+                return 1;
+            }
+            break;
         case 'c':
             capacity_mode = atoi(optarg);
             if (capacity_mode < 0 || capacity_mode > 2)
@@ -94,6 +170,40 @@ int main(int argc, char *argv[])
         case 'f':
             input_file = optarg;
             break;
+        case 'o':
+            output_file = optarg;
+            break;
+        case 'R':
+            reorder_method = parse_reorder_method(optarg);
+            if (reorder_method < 0)
+            {
+                fprintf(stderr, "Invalid reordering. Use none, degree, rcm, or gorder.\n");
+                return 1;
+            }
+            break;
+        case 'j':
+            num_threads = atoi(optarg);
+            if (num_threads < 1)
+            {
+                fprintf(stderr, "Invalid thread count. Use a value >= 1.\n");
+                return 1;
+            }
+            break;
+        case 'd':
+            deterministic = 1;
+            break;
+        case 'S':
+            sell_sigma = 1;
+            if (sscanf(optarg, "%d,%d", &sell_chunk, &sell_sigma) < 1 ||
+                sell_chunk < 1 || sell_chunk > 1024 || sell_sigma < 1)
+            {
+                fprintf(stderr, "Invalid SELL layout. Use C[,sigma] with 1 <= C <= 1024 and sigma >= 1.\n");
+                return 1;
+            }
+            break;
+        case 's':
+            seed = (uint64_t)strtoull(optarg, NULL, 10);
+            break;
         case 'h':
             print_usage(argv[0]);
             return 0;
@@ -105,13 +215,24 @@ int main(int argc, char *argv[])
 
     game_system game;
     graph *g = NULL;
-    srand((unsigned int)time(NULL));
+    graph_order *order = NULL;
+    rng_set_seed(seed);
+    printf("[INFO] Seed: %" PRIu64 "\n", seed);
+    parallel_init(num_threads);
 
 
     if (input_file != NULL)
     {
         printf("[INFO] Loading graph from file: %s\n", input_file);
-        g = load_graph_from_text(input_file);
+        if (output_file != NULL && !is_binary_graph_file(input_file))
+        {
+            /* Build the binary file straight from the edge list, then map it. */
+            if (!convert_text_to_binary(input_file, output_file, GRAPH_STREAM_WINDOW_BYTES))
+                return 1;
+            input_file = output_file;
+            output_file = NULL;
+        }
+        g = load_graph(input_file);
         if (!g)
         {
             fprintf(stderr, "Error: Failed to load graph from file '%s'.\n", input_file);
@@ -138,6 +259,17 @@ int main(int argc, char *argv[])
             printf("[INFO] Barabasi-Albert: m = %d\n", k_param);
             g = generate_barabasi_albert(num_nodes, k_param);
         }
+        else if (graph_type == TYPE_RMAT)
+        {
+            eidx_t edges = (eidx_t)((int64_t)num_nodes * k_param / 2);
+            printf("[INFO] R-MAT: %" PRIeidx " edges drawn (a=0.57, b=c=0.19), duplicates merged\n", edges);
+            g = generate_rmat(num_nodes, edges);
+        }
+        else if (graph_type == TYPE_WATTS_STROGATZ)
+        {
+            printf("[INFO] Watts-Strogatz: ring degree %d, beta = %lf\n", k_param, rewire_prob);
+            g = generate_watts_strogatz(num_nodes, k_param, rewire_prob);
+        }
 
         if (!g)
         {
@@ -148,29 +280,59 @@ int main(int argc, char *argv[])
         save_graph_to_text(g, GRAPH_FILENAME);
     }
 
+    if (output_file != NULL && !save_graph_to_file(g, output_file))
+    {
+        fprintf(stderr, "Error: Failed to write graph to '%s'.\n", output_file);
+        return 1;
+    }
+
+    /* Files keep the original ids; only the in-memory graph is relabelled. */
+    if (reorder_method != REORDER_NONE)
+    {
+        double reorder_start = wall_seconds();
+        double before = mean_neighbor_distance(g);
+        graph *relabelled = NULL;
+
+        order = compute_graph_order(g, reorder_method);
+        if (order)
+            relabelled = apply_graph_order(g, order);
+        if (!relabelled)
+        {
+            fprintf(stderr, "Error: Failed to reorder graph.\n");
+            return 1;
+        }
+        free_graph(g);
+        g = relabelled;
+
+        printf("[INFO] Reordered nodes (%s) in %.2fs, mean neighbour id distance %.1f -> %.1f\n",
+               reorder_method_name(reorder_method), wall_seconds() - reorder_start,
+               before, mean_neighbor_distance(g));
+    }
+
 
     char log_filename[256];
     snprintf(log_filename, sizeof(log_filename), "log_n%d_k%d_t%d_a%d_c%d.log", 
              num_nodes, k_param, graph_type, algorithm, capacity_mode);
     LOG_INIT(log_filename);
 
-    clock_t start_time = clock();
+    double start_time = wall_seconds();
 
     if (algorithm == ALGO_SHAPLEY)
     {
 
         printf("\n=== COALITIONAL GAME APPROACH ===\n");
-        printf("Algorithm: Shapley Values (Monte Carlo)\n");
+        printf("Algorithm: Shapley Values\n");
         printf("Characteristic function version: %d\n", shapley_version);
-        printf("Monte Carlo iterations: %d\n\n", max_it);
+        printf("Monte Carlo iterations (if sampled): %d\n\n", max_it);
 
 
-        double *shapley_values = calculate_shapley_values(g, (int)max_it, shapley_version);
+        double *shapley_values = calculate_shapley_values(g, (int)max_it, shapley_version, shapley_method,
+                                                           shapley_ci_width, shapley_top_k);
 
 
         unsigned char *shapley_set = build_security_set_from_shapley(g, shapley_values);
 
-        double elapsed = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+        double elapsed = wall_seconds() - start_time;
         printf("\n[OK] Shapley computation finished in %.2fs\n", elapsed);
 
 
@@ -212,7 +374,7 @@ int main(int argc, char *argv[])
         node_shapley *sorted = malloc(g->num_nodes * sizeof(node_shapley));
         for (int i = 0; i < g->num_nodes; ++i)
         {
-            sorted[i].id = i;
+            sorted[i].id = graph_order_original(order, i);
             sorted[i].value = shapley_values[i];
         }
 
@@ -234,16 +396,16 @@ int main(int argc, char *argv[])
         {
             printf("  %2d. Node %d: %.6f %s\n", 
                    i + 1, sorted[i].id, sorted[i].value,
-                   shapley_set[sorted[i].id] ? "(in set)" : "");
+                   shapley_set[graph_order_relabel(order, sorted[i].id)] ? "(in set)" : "");
         }
 
         free(coalition);
         free(sorted);
         free(shapley_values);
 
-        init_game(&game, g);
+        init_game(&game, g, order);
 
-        memcpy(game.strategies, shapley_set, g->num_nodes * sizeof(unsigned char));
+        game_assign_strategies(&game, shapley_set);
         free(shapley_set);
         
 
@@ -253,12 +415,21 @@ int main(int argc, char *argv[])
     {
 
         printf("\n=== STRATEGIC GAME APPROACH ===\n");
-        init_game(&game, g);
+        init_game(&game, g, order);
 
         if (algorithm == ALGO_BRD)
         {
             printf("Algorithm: Best Response Dynamics (BRD)\n");
         }
+        else if (algorithm == ALGO_BRD_WORKLIST)
+        {
+            printf("Algorithm: Best Response Dynamics, worklist-driven (BRD_Worklist)\n");
+        }
+        else if (algorithm == ALGO_BRD_COLORED)
+        {
+            printf("Algorithm: Best Response Dynamics, colour-parallel (BRD_Colored, %d threads)\n",
+                   parallel_num_threads());
+        }
         else if (algorithm == ALGO_RM)
         {
             printf("Algorithm: Regret Matching (RM)\n");
@@ -273,12 +444,35 @@ int main(int argc, char *argv[])
         {
             printf("Algorithm: Async Fictitious Play (FP_Async)\n");
             init_fictitious_system(&game);
+            game.fs.deterministic = deterministic;
+            if (parallel_num_threads() > 1 || deterministic)
+            {
+                printf("[INFO] Parallel async FP on %d threads (%s)\n", parallel_num_threads(),
+                       deterministic ? "deterministic colour epochs" : "hogwild");
+            }
+        }
+
+        if (sell_chunk > 0 && (algorithm == ALGO_FP || (algorithm == ALGO_FP_ASYNC && !deterministic)))
+        {
+            game.sell = build_sell_matrix(g, sell_chunk, sell_sigma);
+            if (!game.sell)
+            {
+                fprintf(stderr, "Error: Failed to build SELL-%d-%d layout.\n", sell_chunk, sell_sigma);
+                return 1;
+            }
+            printf("[INFO] SELL-%d-%d layout: %" PRIeidx " stored entries for %" PRIeidx " edges (%.1f%% padding)\n",
+                   sell_chunk, sell_sigma, game.sell->chunk_ptr[game.sell->num_chunks], g->num_edges,
+                   g->num_edges ? 100.0 * (game.sell->chunk_ptr[game.sell->num_chunks] - g->num_edges) / g->num_edges : 0.0);
+        }
+        else if (sell_chunk > 0)
+        {
+            printf("[WARN] -S only applies to FP and hogwild FP_Async; using CSR\n");
         }
 
         int result = run_simulation(&game, algorithm, max_it, 1);
         int converged = (result != -1);
 
-        double elapsed = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+        double elapsed = wall_seconds() - start_time;
         printf("\n[OK] Simulation finished in %.2fs\n", elapsed);
 
         if (converged)
@@ -294,12 +488,7 @@ int main(int argc, char *argv[])
         int minimal = is_minimal(&game);
         int valid = is_valid_cover(&game);
 
-        long active_count = 0;
-        for (int i = 0; i < game.num_players; ++i)
-        {
-            if (game.strategies[i] == 1)
-                active_count++;
-        }
+        long active_count = (long)bitset_count(game.strategy_bits, game.num_players);
 
         printf("\n=== RESULTS ===\n");
         printf("Cover Size: %ld / %d (%.2f%%)\n", active_count, game.num_players, (double)active_count / game.num_players * 100.0);
@@ -318,20 +507,30 @@ int main(int argc, char *argv[])
     }
 
 
+    unsigned char *security_set = bitset_to_bytes(game.strategy_bits, game.num_players);
+    if (!security_set)
+    {
+        fprintf(stderr, "Error: Memory allocation failed for the security set\n");
+        return 1;
+    }
+
     if (capacity_mode == 0 || capacity_mode == 2) {
-        run_part3_matching_market(g, game.strategies, 0);
+        run_part3_matching_market(g, security_set, 0);
     }
     if (capacity_mode == 1 || capacity_mode == 2) {
-        run_part3_matching_market(g, game.strategies, 1);
+        run_part3_matching_market(g, security_set, 1);
     }
 
 
-    run_part4_vcg_auction(g, game.strategies);
+    run_part4_vcg_auction(g, security_set, order);
+    free(security_set);
 
 
     LOG_CLOSE();
     free_game(&game);
     free_graph(g);
+    free_graph_order(order);
+    parallel_shutdown();
 
     return 0;
 }
\ No newline at end of file
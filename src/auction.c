@@ -6,7 +6,9 @@
 #include <math.h>
 #include "../include/auction.h"
 #include "../include/data_structures.h"
+#include "../include/graph_reorder.h"
 #include "../include/logging.h"
+#include "../include/rng.h"
 
 #define INF_DIST 1e14
 #define PENALTY_COST 200.0
@@ -48,10 +50,10 @@ static path_t get_shortest_path(graph *g, int s, int t, int *bids,
         visited[u] = 1;
         if (u == t) break;
 
-        int start = g->row_ptr[u];
-        int end = g->row_ptr[u + 1];
+        eidx_t start = g->row_ptr[u];
+        eidx_t end = g->row_ptr[u + 1];
 
-        for(int k=start; k<end; k++) {
+        for(eidx_t k=start; k<end; k++) {
             int v = g->col_ind[k];
 
             if (v == exclude_node) continue;
@@ -92,9 +94,9 @@ static path_t get_shortest_path(graph *g, int s, int t, int *bids,
 
 static void verify_vcg_truthfulness(graph *g, int s, int t, int *bids,
                                     unsigned char *sec_set, int winner_id,
-                                    double winner_payment)
+                                    double winner_payment, const graph_order *order)
 {
-    printf("\n    [INFO] Testing Dominant Strategy for Node %d...\n", winner_id);
+    printf("\n    [INFO] Testing Dominant Strategy for Node %d...\n", graph_order_original(order, winner_id));
 
     int true_cost = bids[winner_id];
     double current_utility = winner_payment - true_cost;
@@ -150,7 +152,7 @@ static void verify_vcg_truthfulness(graph *g, int s, int t, int *bids,
     }
 }
 
-void run_part4_vcg_auction(graph *g, unsigned char *sec_set) {
+void run_part4_vcg_auction(graph *g, unsigned char *sec_set, const graph_order *order) {
     printf("\n=== PART 4: VCG AUCTION MECHANISM ===\n");
     printf("Objective: Minimize Social Cost (Bids + Disutility of Unsecure Nodes)\n");
     printf("Disutility Penalty: %.0f\n", PENALTY_COST);
@@ -165,31 +167,36 @@ void run_part4_vcg_auction(graph *g, unsigned char *sec_set) {
         fprintf(stderr, "Error: Memory allocation failed for bids\n");
         return;
     }
+    rng_state rng;
+    rng_init(&rng, RNG_STREAM_AUCTION, 0);
     for(int i=0; i<(int)g->num_nodes; i++) {
-        bids[i] = (rand() % 90) + 10;
+        bids[graph_order_relabel(order, i)] = (int)rng_next_bounded(&rng, 90) + 10;
     }
 
     int s = 0;
     int t = 0;
     while (s == t) {
-        s = rand() % g->num_nodes;
-        t = rand() % g->num_nodes;
+        s = (int)rng_next_bounded(&rng, (uint32_t)g->num_nodes);
+        t = (int)rng_next_bounded(&rng, (uint32_t)g->num_nodes);
     }
     printf("Auction Request: Path from Node %d to %d\n", s, t);
+    s = graph_order_relabel(order, s);
+    t = graph_order_relabel(order, t);
 
     path_t optimal = get_shortest_path(g, s, t, bids, sec_set, -1);
 
     if (optimal.length == 0 || optimal.cost >= INF_DIST) {
-        printf("[WARN] No path exists between %d and %d. Auction cancelled.\n", s, t);
+        printf("[WARN] No path exists between %d and %d. Auction cancelled.\n",
+               graph_order_original(order, s), graph_order_original(order, t));
         free(bids);
         return;
     }
 
     printf("[INFO] Winning Path: [ ");
-    for(int i=0; i<optimal.length; i++) printf("%d ", optimal.nodes[i]);
+    for(int i=0; i<optimal.length; i++) printf("%d ", graph_order_original(order, optimal.nodes[i]));
     printf("]\n[INFO] Total Social Cost: %.2f\n", optimal.cost);
 
-    LOG_P4_START(s, t);
+    LOG_P4_START(graph_order_original(order, s), graph_order_original(order, t));
 
     printf("\n--- VCG PAYMENTS ---\n");
     printf("| Node | Type  | Bid | External Cost | Payment | Utility |\n");
@@ -206,15 +213,15 @@ void run_part4_vcg_auction(graph *g, unsigned char *sec_set) {
 
         if (alt.cost >= INF_DIST) {
             printf("| %4d | %s   | %3d |      INF      |   INF   |   INF   | (Monopoly/Bridge)\n",
-                   u, sec_set[u]?"SEC":"UNS", bids[u]);
+                   graph_order_original(order, u), sec_set[u]?"SEC":"UNS", bids[u]);
         } else {
             double payment = alt.cost - cost_others;
             double utility = payment - bids[u];
 
             printf("| %4d | %s   | %3d | %13.2f | %7.2f | %7.2f |\n",
-                   u, sec_set[u]?"SEC":"UNS", bids[u], alt.cost, payment, utility);
+                   graph_order_original(order, u), sec_set[u]?"SEC":"UNS", bids[u], alt.cost, payment, utility);
 
-            LOG_P4_PAY(u, bids[u], payment);
+            LOG_P4_PAY(graph_order_original(order, u), bids[u], payment);
         }
 
         if(alt.nodes) free(alt.nodes);
@@ -231,9 +238,9 @@ void run_part4_vcg_auction(graph *g, unsigned char *sec_set) {
         
         if (alt.cost < INF_DIST) {
             double payment = alt.cost - cost_others;
-            verify_vcg_truthfulness(g, s, t, bids, sec_set, u, payment);
+            verify_vcg_truthfulness(g, s, t, bids, sec_set, u, payment, order);
         } else {
-            printf("    [INFO] Node %d skipped (Monopoly/Bridge - no alternative path)\n", u);
+            printf("    [INFO] Node %d skipped (Monopoly/Bridge - no alternative path)\n", graph_order_original(order, u));
         }
         if(alt.nodes) free(alt.nodes);
     }
@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/bitset.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+uint64_t *bitset_create(int num_bits)
+{
+    return (uint64_t *)calloc(BITSET_WORDS(num_bits), sizeof(uint64_t));
+}
+
+uint64_t *bitset_from_bytes(const unsigned char *bytes, int num_bits)
+{
+    uint64_t *bits = bitset_create(num_bits);
+    if (!bits)
+        return NULL;
+
+    for (int w = 0; w < (int)BITSET_WORDS(num_bits); ++w)
+    {
+        uint64_t word = 0;
+        int base = w * 64;
+        int limit = (num_bits - base < 64) ? num_bits - base : 64;
+        for (int b = 0; b < limit; ++b)
+        {
+            word |= (uint64_t)(bytes[base + b] != 0) << b;
+        }
+        bits[w] = word;
+    }
+    return bits;
+}
+
+uint64_t *bitset_from_list(const int *items, size_t count, int num_bits)
+{
+    uint64_t *bits = bitset_create(num_bits);
+    if (!bits)
+        return NULL;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        bitset_set(bits, items[i]);
+    }
+    return bits;
+}
+
+unsigned char *bitset_to_bytes(const uint64_t *bits, int num_bits)
+{
+    unsigned char *bytes = (unsigned char *)malloc((size_t)num_bits);
+    if (!bytes)
+        return NULL;
+
+    for (int i = 0; i < num_bits; ++i)
+    {
+        bytes[i] = (unsigned char)bitset_test(bits, i);
+    }
+    return bytes;
+}
+
+size_t bitset_count(const uint64_t *bits, int num_bits)
+{
+    size_t words = BITSET_WORDS(num_bits);
+    size_t total = 0;
+    for (size_t w = 0; w < words; ++w)
+    {
+        total += (size_t)__builtin_popcountll(bits[w]);
+    }
+    return total;
+}
+
+/*
+ * Gather kernels over one adjacency row. They return how many neighbours in
+ * col_ind[start, end) are members of the set. On AVX2 the membership bits
+ * of eight neighbours are fetched with one gather on the 32-bit view of the
+ * words (valid on little-endian targets); other targets, NEON included, use
+ * the scalar loop, which the compiler unrolls and popcount lowers to CNT.
+ */
+static int count_members(const int *col_ind, eidx_t start, eidx_t end, const uint64_t *bits)
+{
+    int members = 0;
+    eidx_t k = start;
+
+#if defined(__AVX2__)
+    const int *words32 = (const int *)bits;
+    const __m256i low5 = _mm256_set1_epi32(31);
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i acc = _mm256_setzero_si256();
+
+    for (; k + 8 <= end; k += 8)
+    {
+        __m256i ids = _mm256_loadu_si256((const __m256i *)(col_ind + k));
+        __m256i words = _mm256_i32gather_epi32(words32, _mm256_srli_epi32(ids, 5), 4);
+        __m256i bit = _mm256_and_si256(_mm256_srlv_epi32(words, _mm256_and_si256(ids, low5)), one);
+        acc = _mm256_add_epi32(acc, bit);
+    }
+
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_hadd_epi32(sum, sum);
+    sum = _mm_hadd_epi32(sum, sum);
+    members = _mm_cvtsi128_si32(sum);
+#endif
+
+    for (; k < end; ++k)
+    {
+        members += bitset_test(bits, col_ind[k]);
+    }
+    return members;
+}
+
+int bitset_count_row(graph *g, int node, const uint64_t *bits)
+{
+    return count_members(g->col_ind, g->row_ptr[node], g->row_ptr[node + 1], bits);
+}
+
+int bitset_is_valid_cover(graph *g, const uint64_t *bits)
+{
+    for (int u = 0; u < g->num_nodes; ++u)
+    {
+        if (bitset_test(bits, u))
+            continue;
+
+        eidx_t start = g->row_ptr[u];
+        eidx_t end = g->row_ptr[u + 1];
+        if (count_members(g->col_ind, start, end, bits) != end - start)
+            return 0;
+    }
+    return 1;
+}
+
+int bitset_is_minimal(graph *g, const uint64_t *bits)
+{
+    for (int u = 0; u < g->num_nodes; ++u)
+    {
+        if (!bitset_test(bits, u))
+            continue;
+
+        eidx_t start = g->row_ptr[u];
+        eidx_t end = g->row_ptr[u + 1];
+        if (count_members(g->col_ind, start, end, bits) == end - start)
+            return 0;
+    }
+    return 1;
+}
@@ -3,16 +3,18 @@
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
-#include <glib.h>
 #include "../include/coalitional_game.h"
+#include "../include/bitset.h"
+#include "../include/parallel.h"
+#include "../include/rng.h"
 
-static void shuffle_array(int *array, size_t n)
+static void shuffle_array(int *array, size_t n, rng_state *rng)
 {
     if (n > 1)
     {
         for (size_t i = 0; i < n - 1; i++)
         {
-            size_t j = i + rand() / (RAND_MAX / (n - i) + 1);
+            size_t j = i + rng_next_bounded(rng, (uint32_t)(n - i));
             int t = array[j];
             array[j] = array[i];
             array[i] = t;
@@ -20,92 +22,285 @@ static void shuffle_array(int *array, size_t n)
     }
 }
 
-typedef struct
+/*
+ * Characteristic functions of the security game:
+ *   v1(C) = 1 if C is a vertex cover, 0 otherwise
+ *   v2(C) = |N[C]|, the number of nodes C dominates (closed neighbourhood)
+ *   v3(C) = number of edges with at least one endpoint in C
+ */
+
+double characteristic_function_v1(graph *g, int *coalition, size_t coalition_size)
 {
-    int u;
-    int v;
-} edge;
+    return (double)is_coalition_valid_cover(g, coalition, coalition_size);
+}
 
-static guint edge_hash(gconstpointer key)
+double characteristic_function_v2(graph *g, int *coalition, size_t coalition_size)
 {
-    const edge *e = (const edge *)key;
-    int hash = e->u ^ (e->v << 1);
-    return (guint)(hash % UINT32_MAX);
+    unsigned char *dominated = calloc(g->num_nodes, sizeof(unsigned char));
+    if (!dominated)
+        return 0.0;
+
+    int count = 0;
+    for (size_t i = 0; i < coalition_size; ++i)
+    {
+        int u = coalition[i];
+        if (!dominated[u])
+        {
+            dominated[u] = 1;
+            count++;
+        }
+        for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
+        {
+            int v = g->col_ind[j];
+            if (!dominated[v])
+            {
+                dominated[v] = 1;
+                count++;
+            }
+        }
+    }
+
+    free(dominated);
+    return (double)count;
 }
 
-static gboolean edge_equal(gconstpointer a, gconstpointer b)
+double characteristic_function_v3(graph *g, int *coalition, size_t coalition_size)
 {
-    const edge *e1 = (const edge *)a;
-    const edge *e2 = (const edge *)b;
-    return (e1->u == e2->u) && (e1->v == e2->v);
+    return (double)count_covered_edges(g, coalition, coalition_size);
 }
 
-static int add_node_edges_to_set(graph *g, int node, GHashTable *edges)
+eidx_t count_covered_edges(graph *g, int *coalition, size_t coalition_size)
 {
-    int new_edges = 0;
-    edge temp_edge;
-    int start = g->row_ptr[node];
-    int end = g->row_ptr[node + 1];
+    uint64_t *in_coalition = bitset_from_list(coalition, coalition_size, g->num_nodes);
+    if (!in_coalition)
+        return 0;
 
-    for (int j = start; j < end; ++j)
+    eidx_t covered = 0;
+    for (int u = 0; u < g->num_nodes; ++u)
     {
-        int neighbor = g->col_ind[j];
+        if (!bitset_test(in_coalition, u))
+            continue;
+        for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
+        {
+            int v = g->col_ind[j];
+            covered += !bitset_test(in_coalition, v) || u < v;
+        }
+    }
 
-        if (node < neighbor)
+    free(in_coalition);
+    return covered;
+}
+
+/*
+ * Marginal-contribution kernels. Each one credits a single permutation
+ * (given as `permutation` and its inverse `position`) into `totals`, in
+ * O(n + m) and without evaluating the characteristic function.
+ */
+
+/* v1: only the node that completes the cover gains 1. */
+static void cover_pivot_sample(const graph *g, const int *permutation, const int *position, int64_t *totals)
+{
+    int pivot = -1;
+
+    for (int u = 0; u < g->num_nodes; ++u)
+    {
+        for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
         {
-            temp_edge.u = node;
-            temp_edge.v = neighbor;
+            int v = g->col_ind[j];
+            int first = position[u] < position[v] ? position[u] : position[v];
+            if (first > pivot)
+                pivot = first;
         }
-        else
+    }
+
+    if (pivot >= 0)
+        totals[permutation[pivot]]++;
+}
+
+/* v2: every node w is newly dominated by the earliest member of N[w]. */
+static void domination_sample(const graph *g, const int *permutation, const int *position, int64_t *totals)
+{
+    (void)permutation;
+
+    for (int w = 0; w < g->num_nodes; ++w)
+    {
+        int first = w;
+        for (eidx_t j = g->row_ptr[w]; j < g->row_ptr[w + 1]; ++j)
         {
-            temp_edge.u = neighbor;
-            temp_edge.v = node;
+            int v = g->col_ind[j];
+            if (position[v] < position[first])
+                first = v;
         }
+        totals[first]++;
+    }
+}
+
+/* v3: a node newly covers the edges whose other endpoint comes later. */
+static void coverage_sample(const graph *g, const int *permutation, const int *position, int64_t *totals)
+{
+    (void)permutation;
 
-        if (!g_hash_table_contains(edges, &temp_edge))
+    for (int u = 0; u < g->num_nodes; ++u)
+    {
+        int pos = position[u];
+        int gain = 0;
+
+        for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
         {
-            edge *new_e = g_new(edge, 1);
-            new_e->u = temp_edge.u;
-            new_e->v = temp_edge.v;
-            g_hash_table_add(edges, new_e);
-            new_edges++;
+            gain += position[g->col_ind[j]] > pos;
         }
+        totals[u] += gain;
     }
-    return new_edges;
 }
 
-static __thread GHashTable *g_edge_cache = NULL;
+/*
+ * Bit-sliced sampling: lane l of word p in `planes[v * SLICE_BITS + p]` is
+ * bit p (MSB first) of node v's random key in permutation l, so 64
+ * permutations are ordered by comparing keys with word-wide operations.
+ * Equal keys are ordered by node id; with 16-bit keys that affects a
+ * given pair in only 2^-16 of the samples.
+ */
+#define SLICE_BITS 16
+
+/* Lanes in which node a comes after node b. */
+static inline uint64_t sliced_after(const uint64_t *a, const uint64_t *b, int a_after_b_on_tie)
+{
+    uint64_t gt = 0;
+    uint64_t eq = ~(uint64_t)0;
 
+    for (int p = 0; p < SLICE_BITS && eq; ++p)
+    {
+        gt |= eq & a[p] & ~b[p];
+        eq &= ~(a[p] ^ b[p]);
+    }
+    return a_after_b_on_tie ? gt | eq : gt;
+}
 
-int is_coalition_valid_cover(graph *g, int *coalition, size_t coalition_size)
+/* v3 over 64 permutations: each neighbour placed later is one new edge. */
+static void coverage_sample64(const graph *g, const uint64_t *planes, uint64_t lanes,
+                              int begin, int end, int64_t *totals)
 {
-    unsigned char *in_coalition = (unsigned char *)calloc(g->num_nodes, sizeof(unsigned char));
-    if (!in_coalition)
+    for (int u = begin; u < end; ++u)
+    {
+        const uint64_t *pu = &planes[(size_t)u * SLICE_BITS];
+        int64_t gain = 0;
+
+        for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
+        {
+            int v = g->col_ind[j];
+            uint64_t later = sliced_after(&planes[(size_t)v * SLICE_BITS], pu, v > u);
+            gain += __builtin_popcountll(later & lanes);
+        }
+        totals[u] += gain;
+    }
+}
+
+/*
+ * Local samplers. A node's marginal contribution under v2/v3 depends only
+ * on the relative order of the nodes within its locality radius, so one
+ * sample for node u is an ordering of that ball alone: node x gets the
+ * random key rng_counter(sample_key, x), with ties ordered by id. The cost
+ * is proportional to the size of the ball instead of n.
+ */
+static inline int local_before(uint64_t sample_key, uint64_t key_a, int a, int b)
+{
+    uint64_t key_b = rng_counter(sample_key, (uint64_t)b);
+    return key_a < key_b || (key_a == key_b && a < b);
+}
+
+/* Whether u comes before every other member of N[w]. */
+static int local_first_in(const graph *g, int u, uint64_t key_u, int w, uint64_t sample_key)
+{
+    if (w != u && !local_before(sample_key, key_u, u, w))
         return 0;
 
-    for (size_t i = 0; i < coalition_size; ++i)
+    for (eidx_t k = g->row_ptr[w]; k < g->row_ptr[w + 1]; ++k)
+    {
+        int x = g->col_ind[k];
+        if (x != u && !local_before(sample_key, key_u, u, x))
+            return 0;
+    }
+    return 1;
+}
+
+/* v2, radius 2: u newly dominates each w in N[u] whose N[w] it enters first. */
+static int domination_local(const graph *g, int u, uint64_t sample_key)
+{
+    uint64_t key_u = rng_counter(sample_key, (uint64_t)u);
+    int gain = local_first_in(g, u, key_u, u, sample_key);
+
+    for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
+    {
+        gain += local_first_in(g, u, key_u, g->col_ind[j], sample_key);
+    }
+    return gain;
+}
+
+/* v3, radius 1: one new edge per neighbour that comes later. */
+static int coverage_local(const graph *g, int u, uint64_t sample_key)
+{
+    uint64_t key_u = rng_counter(sample_key, (uint64_t)u);
+    int gain = 0;
+
+    for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
     {
-        in_coalition[coalition[i]] = 1;
+        gain += local_before(sample_key, key_u, u, g->col_ind[j]);
     }
+    return gain;
+}
+
+/*
+ * Exact evaluators, O(n + m). Node w is dominated by whichever member of
+ * N[w] comes first, each with probability 1/(deg(w)+1); an edge is covered
+ * by whichever endpoint comes first, so each endpoint gets 1/2.
+ */
 
-    int is_valid = 1;
+static void domination_exact(const graph *g, double *values)
+{
     for (int u = 0; u < g->num_nodes; ++u)
     {
-        for (int k = g->row_ptr[u]; k < g->row_ptr[u + 1]; ++k)
+        double value = 1.0 / (double)(g->row_ptr[u + 1] - g->row_ptr[u] + 1);
+        for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
         {
-            int v = g->col_ind[k];
-            if (u >= v)
-                continue;
-
-            if (!in_coalition[u] && !in_coalition[v])
-            {
-                is_valid = 0;
-                break;
-            }
+            int w = g->col_ind[j];
+            value += 1.0 / (double)(g->row_ptr[w + 1] - g->row_ptr[w] + 1);
         }
-        if (!is_valid)
-            break;
+        values[u] = value;
     }
+}
+
+static void coverage_exact(const graph *g, double *values)
+{
+    for (int u = 0; u < g->num_nodes; ++u)
+    {
+        values[u] = 0.5 * (double)(g->row_ptr[u + 1] - g->row_ptr[u]);
+    }
+}
+
+typedef struct
+{
+    const char *name;
+    void (*sample)(const graph *g, const int *permutation, const int *position, int64_t *totals);
+    void (*sample64)(const graph *g, const uint64_t *planes, uint64_t lanes, int begin, int end, int64_t *totals);
+    void (*exact)(const graph *g, double *values);
+    int locality;
+    int (*local)(const graph *g, int u, uint64_t sample_key);
+} shapley_characteristic;
+
+/* locality: radius of the ball a marginal depends on, -1 if global. */
+static const shapley_characteristic characteristics[] = {
+    {"v1 (vertex cover indicator)", cover_pivot_sample, NULL, NULL, -1, NULL},
+    {"v2 (closed-neighbourhood domination)", domination_sample, NULL, domination_exact, 2, domination_local},
+    {"v3 (edge coverage)", coverage_sample, coverage_sample64, coverage_exact, 1, coverage_local},
+};
+
+int is_coalition_valid_cover(graph *g, int *coalition, size_t coalition_size)
+{
+    uint64_t *in_coalition = bitset_from_list(coalition, coalition_size, g->num_nodes);
+    if (!in_coalition)
+        return 0;
+
+    int is_valid = bitset_is_valid_cover(g, in_coalition);
 
     free(in_coalition);
     return is_valid;
@@ -113,116 +308,479 @@ int is_coalition_valid_cover(graph *g, int *coalition, size_t coalition_size)
 
 int is_coalition_minimal(graph *g, int *coalition, size_t coalition_size)
 {
-    unsigned char *in_coalition = (unsigned char *)calloc(g->num_nodes, sizeof(unsigned char));
-    unsigned char *has_private = (unsigned char *)calloc(g->num_nodes, sizeof(unsigned char));
+    uint64_t *in_coalition = bitset_from_list(coalition, coalition_size, g->num_nodes);
+    if (!in_coalition)
+        return 0;
+
+    int minimal = bitset_is_minimal(g, in_coalition);
+
+    free(in_coalition);
+    return minimal;
+}
+
+typedef struct
+{
+    int *permutation;
+    int *position;
+    int64_t *scratch;
+    int64_t *totals;
+    int64_t *sumsq;
+} shapley_buffers;
 
-    if (!in_coalition || !has_private)
+typedef struct
+{
+    graph *g;
+    const shapley_characteristic *fn;
+    long begin;
+    long end;
+    int antithetic;
+    shapley_buffers *buffers;
+    int64_t *totals;
+    int64_t *sumsq;
+} shapley_task;
+
+static int shapley_buffers_init(shapley_buffers *buf, size_t n, int antithetic)
+{
+    buf->permutation = malloc(n * sizeof(int));
+    buf->position = malloc(n * sizeof(int));
+    buf->totals = calloc(n, sizeof(int64_t));
+    if (antithetic)
     {
-        free(in_coalition);
-        free(has_private);
-        return 0;
+        buf->scratch = calloc(n, sizeof(int64_t));
+        buf->sumsq = calloc(n, sizeof(int64_t));
     }
+    return buf->permutation && buf->position && buf->totals &&
+           (!antithetic || (buf->scratch && buf->sumsq));
+}
 
-    for (size_t i = 0; i < coalition_size; ++i)
+static void shapley_buffers_free(shapley_buffers *buf)
+{
+    free(buf->permutation);
+    free(buf->position);
+    free(buf->scratch);
+    free(buf->totals);
+    free(buf->sumsq);
+}
+
+/*
+ * Sample k is drawn from its own RNG stream, so which thread computes it
+ * does not matter; integer accumulators make the reduction exact. In
+ * antithetic mode a sample is the pair (pi, reverse(pi)): the two marginal
+ * vectors are summed in `scratch` and its moments are accumulated.
+ */
+static void shapley_sample_worker(int thread_id, int num_threads, void *arg)
+{
+    shapley_task *task = (shapley_task *)arg;
+    shapley_buffers *buf = &task->buffers[thread_id];
+    graph *g = task->g;
+    size_t n = g->num_nodes;
+    long begin, end;
+
+    parallel_block(task->end - task->begin, thread_id, num_threads, &begin, &end);
+    begin += task->begin;
+    end += task->begin;
+
+    if (!buf->permutation && !shapley_buffers_init(buf, n, task->antithetic))
     {
-        in_coalition[coalition[i]] = 1;
+        fprintf(stderr, "Error: Memory allocation failed in Shapley worker %d\n", thread_id);
+        return;
     }
 
-    for (int u = 0; u < g->num_nodes; ++u)
+    int *permutation = buf->permutation;
+    int *position = buf->position;
+
+    for (long iter = begin; iter < end; ++iter)
     {
-        for (int k = g->row_ptr[u]; k < g->row_ptr[u + 1]; ++k)
+        rng_state rng;
+        rng_init(&rng, RNG_STREAM_SHAPLEY, (uint64_t)iter);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            permutation[i] = i;
+        }
+        shuffle_array(permutation, n, &rng);
+
+        for (size_t i = 0; i < n; ++i)
         {
-            int v = g->col_ind[k];
-            if (u >= v)
-                continue;
+            position[permutation[i]] = (int)i;
+        }
 
+        if (!task->antithetic)
+        {
+            task->fn->sample(g, permutation, position, buf->totals);
+        }
+        else
+        {
+            task->fn->sample(g, permutation, position, buf->scratch);
 
-            if (in_coalition[u] && !in_coalition[v])
+            for (size_t i = 0; i < n / 2; ++i)
             {
-                has_private[u] = 1;
+                int t = permutation[i];
+                permutation[i] = permutation[n - 1 - i];
+                permutation[n - 1 - i] = t;
             }
-            else if (!in_coalition[u] && in_coalition[v])
+            for (size_t i = 0; i < n; ++i)
+            {
+                position[i] = (int)(n - 1) - position[i];
+            }
+            task->fn->sample(g, permutation, position, buf->scratch);
+
+            for (size_t i = 0; i < n; ++i)
             {
-                has_private[v] = 1;
+                int64_t x = buf->scratch[i];
+                buf->totals[i] += x;
+                buf->sumsq[i] += x * x;
+                buf->scratch[i] = 0;
             }
         }
+
+        if (thread_id == 0 && (iter - begin) % 100 == 0 && iter > begin)
+            printf("[INFO] Iteration ~%ld/%ld completed\n", task->begin + (iter - begin) * num_threads, task->end);
     }
+}
 
-    int minimal = 1;
-    for (size_t i = 0; i < coalition_size; ++i)
+static void shapley_reduce_worker(int thread_id, int num_threads, void *arg)
+{
+    shapley_task *task = (shapley_task *)arg;
+    long begin, end;
+
+    parallel_block(task->g->num_nodes, thread_id, num_threads, &begin, &end);
+
+    for (long i = begin; i < end; ++i)
     {
-        if (!has_private[coalition[i]])
+        task->totals[i] = 0;
+        if (task->sumsq)
+            task->sumsq[i] = 0;
+    }
+
+    for (int t = 0; t < num_threads; ++t)
+    {
+        const shapley_buffers *buf = &task->buffers[t];
+        if (!buf->totals)
+            continue;
+        for (long i = begin; i < end; ++i)
         {
-            minimal = 0;
-            break;
+            task->totals[i] += buf->totals[i];
+        }
+        if (task->sumsq && buf->sumsq)
+        {
+            for (long i = begin; i < end; ++i)
+            {
+                task->sumsq[i] += buf->sumsq[i];
+            }
         }
     }
+}
 
-    free(in_coalition);
-    free(has_private);
-    return minimal;
+typedef struct
+{
+    graph *g;
+    const shapley_characteristic *fn;
+    long iterations;
+    const int *bounds;
+    uint64_t *planes;
+    int64_t *totals;
+} shapley_sliced_task;
+
+/*
+ * One pass per batch of 64 permutations: every thread draws the key planes
+ * of its node range, then scans its range of the CSR once for all lanes.
+ * Batch b uses RNG stream (SHAPLEY, b) and each node owns its total, so the
+ * result does not depend on the thread count.
+ */
+static void shapley_sliced_worker(int thread_id, int num_threads, void *arg)
+{
+    shapley_sliced_task *task = (shapley_sliced_task *)arg;
+    int begin = task->bounds[thread_id];
+    int end = task->bounds[thread_id + 1];
+    long batches = (task->iterations + 63) / 64;
+
+    (void)num_threads;
+
+    for (long b = 0; b < batches; ++b)
+    {
+        uint64_t key = rng_stream_key(RNG_STREAM_SHAPLEY, (uint64_t)b);
+        long lanes_used = task->iterations - b * 64 < 64 ? task->iterations - b * 64 : 64;
+        uint64_t lanes = lanes_used == 64 ? ~(uint64_t)0 : (((uint64_t)1 << lanes_used) - 1);
+
+        for (size_t i = (size_t)begin * SLICE_BITS; i < (size_t)end * SLICE_BITS; ++i)
+        {
+            task->planes[i] = rng_counter(key, i);
+        }
+        parallel_barrier();
+
+        task->fn->sample64(task->g, task->planes, lanes, begin, end, task->totals);
+        parallel_barrier();
+
+        if (thread_id == 0 && b % 16 == 0 && b > 0)
+            printf("[INFO] Iteration %ld/%ld completed\n", b * 64, task->iterations);
+    }
 }
 
-double *calculate_shapley_values(graph *g, int iterations, int version)
+typedef struct
+{
+    graph *g;
+    const shapley_characteristic *fn;
+    long iterations;
+    const int *bounds;
+    double *values;
+} shapley_local_task;
+
+/* Nodes are independent: sample s of node u uses key (SHAPLEY, u), counter s. */
+static void shapley_local_worker(int thread_id, int num_threads, void *arg)
 {
-    // STA ZITTO GCC
-    (void)version;
+    shapley_local_task *task = (shapley_local_task *)arg;
 
-    size_t n = g->num_nodes;
+    (void)num_threads;
 
-    double *shapley_values = calloc(n, sizeof(double));
+    for (int u = task->bounds[thread_id]; u < task->bounds[thread_id + 1]; ++u)
+    {
+        uint64_t node_key = rng_stream_key(RNG_STREAM_SHAPLEY, (uint64_t)u);
+        int64_t total = 0;
 
-    int *permutation = malloc(n * sizeof(int));
-    for (size_t i = 0; i < n; i++)
+        for (long s = 0; s < task->iterations; ++s)
+        {
+            total += task->fn->local(task->g, u, rng_counter(node_key, (uint64_t)s));
+        }
+        task->values[u] = (double)total / task->iterations;
+    }
+}
+
+typedef struct
+{
+    int id;
+    int64_t total;
+} shapley_rank;
+
+static int compare_int(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+static int compare_rank(const void *a, const void *b)
+{
+    const shapley_rank *ra = (const shapley_rank *)a;
+    const shapley_rank *rb = (const shapley_rank *)b;
+
+    if (ra->total != rb->total)
+        return ra->total < rb->total ? 1 : -1;
+    return ra->id - rb->id;
+}
+
+/* Fills `top` with the ids of the k largest totals (ties by id), sorted by id. */
+static void top_k_nodes(const int64_t *totals, size_t n, int k, shapley_rank *scratch, int *top)
+{
+    for (size_t i = 0; i < n; ++i)
     {
-        permutation[i] = i;
+        scratch[i].id = (int)i;
+        scratch[i].total = totals[i];
     }
+    qsort(scratch, n, sizeof(shapley_rank), compare_rank);
 
-    printf("[INFO] Starting optimized Shapley calculation (%d iterations)...\n", iterations);
+    for (int i = 0; i < k; ++i)
+    {
+        top[i] = scratch[i].id;
+    }
+    qsort(top, k, sizeof(int), compare_int);
+}
 
-    GHashTable *edges = g_hash_table_new_full(edge_hash, edge_equal, g_free, NULL);
+/*
+ * Largest 95% confidence half-width over all nodes, from the exact integer
+ * moments of the pair sums X (each pair estimates phi as X / 2).
+ */
+static double max_ci_half_width(const int64_t *totals, const int64_t *sumsq, size_t n, long pairs)
+{
+    double worst = 0.0;
 
-    for (int iter = 0; iter < iterations; ++iter)
+    for (size_t i = 0; i < n; ++i)
     {
-        shuffle_array(permutation, n);
+        double mean = (double)totals[i] / pairs;
+        double var = ((double)sumsq[i] - mean * (double)totals[i]) / (pairs - 1);
+        if (var < 0.0)
+            var = 0.0;
+        double half = 1.96 * 0.5 * sqrt(var / pairs);
+        if (half > worst)
+            worst = half;
+    }
+    return worst;
+}
 
-        g_hash_table_remove_all(edges);
-        int current_covered = 0;
+#define SHAPLEY_MIN_PAIRS 32
+#define SHAPLEY_STABLE_CHECKS 3
 
-        for (size_t i = 0; i < n; ++i)
-        {
-            int curr_node = permutation[i];
+double *calculate_shapley_values(graph *g, int iterations, int version, int method,
+                                 double ci_width, int top_k)
+{
+    size_t n = g->num_nodes;
+    int num_threads = parallel_num_threads();
+
+    if (version < 1 || version > 3)
+        version = 3;
+    const shapley_characteristic *fn = &characteristics[version - 1];
+
+    double *shapley_values = calloc(n, sizeof(double));
+    if (!shapley_values)
+        return NULL;
+
+    /* An explicit -e or -r asks for the adaptive sampler, so auto skips
+     * the exact evaluator; the exact and local methods ignore them. */
+    int adaptive = ci_width > 0.0 || top_k > 0;
+    if (method == SHAPLEY_AUTO && fn->exact && adaptive)
+        printf("[INFO] Stopping rule given, sampling %s adaptively instead of exact evaluation\n", fn->name);
+    if (adaptive && ((method == SHAPLEY_EXACT && fn->exact) || (method == SHAPLEY_LOCAL && fn->local)))
+        printf("[WARN] -e/-r only apply to Monte Carlo sampling; ignored by the %s method\n",
+               method == SHAPLEY_EXACT ? "exact" : "local");
+
+    if (((method == SHAPLEY_AUTO && !adaptive) || method == SHAPLEY_EXACT) && fn->exact)
+    {
+        printf("[INFO] Exact Shapley evaluation for %s\n", fn->name);
+        fn->exact(g, shapley_values);
+        printf("[OK] Shapley calculation completed\n");
+        return shapley_values;
+    }
+    if (method == SHAPLEY_EXACT)
+        printf("[WARN] No exact evaluator for %s, falling back to Monte Carlo\n", fn->name);
 
-            double value_without = (double)current_covered;
+    if (method == SHAPLEY_LOCAL && !fn->local)
+        printf("[WARN] %s is not locality-bounded, falling back to Monte Carlo\n", fn->name);
 
-            int new_edges = add_node_edges_to_set(g, curr_node, edges);
-            current_covered += new_edges;
+    if (method == SHAPLEY_LOCAL && fn->local)
+    {
+        int *bounds = malloc((num_threads + 1) * sizeof(int));
+        if (bounds)
+        {
+            printf("[INFO] Starting local Shapley sampler for %s (radius %d, %d samples per node, %d threads)...\n",
+                   fn->name, fn->locality, iterations, num_threads);
+
+            parallel_partition_by_edges(g, num_threads, bounds);
+            shapley_local_task task = {g, fn, iterations, bounds, shapley_values};
+            parallel_run(shapley_local_worker, &task);
+            free(bounds);
+            printf("[OK] Shapley calculation completed\n");
+            return shapley_values;
+        }
+    }
 
-            double value_with = (double)current_covered;
+    if (fn->sample64 && method != SHAPLEY_MONTE_CARLO_SCALAR && !adaptive)
+    {
+        uint64_t *planes = malloc(n * SLICE_BITS * sizeof(uint64_t));
+        int64_t *totals = calloc(n, sizeof(int64_t));
+        int *bounds = malloc((num_threads + 1) * sizeof(int));
+        int sliced = planes && totals && bounds;
+        if (sliced)
+        {
+            printf("[INFO] Starting bit-sliced Monte Carlo Shapley for %s (%d iterations, 64 per pass, %d threads)...\n",
+                   fn->name, iterations, num_threads);
 
-            double marginal_contribution = value_with - value_without;
+            parallel_partition_by_edges(g, num_threads, bounds);
+            shapley_sliced_task task = {g, fn, iterations, bounds, planes, totals};
+            parallel_run(shapley_sliced_worker, &task);
 
-            shapley_values[curr_node] += marginal_contribution;
+            for (size_t i = 0; i < n; i++)
+            {
+                shapley_values[i] = (double)totals[i] / iterations;
+            }
         }
+        free(planes);
+        free(totals);
+        free(bounds);
+        if (sliced)
+        {
+            printf("[OK] Shapley calculation completed\n");
+            return shapley_values;
+        }
+        printf("[WARN] Not enough memory for bit-sliced sampling, using the scalar engine\n");
+    }
 
-        if (iter % 100 == 0 && iter > 0)
-            printf("[INFO] Iteration %d/%d completed\n", iter, iterations);
+    if (top_k > (int)n)
+        top_k = (int)n;
+
+    shapley_buffers *buffers = calloc(num_threads, sizeof(shapley_buffers));
+    int64_t *totals = calloc(n, sizeof(int64_t));
+    int64_t *sumsq = adaptive ? calloc(n, sizeof(int64_t)) : NULL;
+    if (!buffers || !totals || (adaptive && !sumsq))
+    {
+        free(buffers);
+        free(totals);
+        free(sumsq);
+        free(shapley_values);
+        return NULL;
     }
 
-    g_hash_table_destroy(edges);
+    shapley_task task = {g, fn, 0, 0, adaptive, buffers, totals, sumsq};
+    double divisor;
 
-    if (g_edge_cache != NULL)
+    if (!adaptive)
     {
-        g_hash_table_destroy(g_edge_cache);
-        g_edge_cache = NULL;
+        printf("[INFO] Starting Monte Carlo Shapley for %s (%d iterations, %d threads)...\n",
+               fn->name, iterations, num_threads);
+
+        task.end = iterations;
+        parallel_run(shapley_sample_worker, &task);
+        parallel_run(shapley_reduce_worker, &task);
+        divisor = (double)iterations;
+    }
+    else
+    {
+        long max_pairs = iterations / 2 > SHAPLEY_MIN_PAIRS ? iterations / 2 : SHAPLEY_MIN_PAIRS;
+        int *top = top_k > 0 ? calloc(2 * top_k, sizeof(int)) : NULL;
+        shapley_rank *ranks = top_k > 0 ? malloc(n * sizeof(shapley_rank)) : NULL;
+        int stable = -1;
+        int done = 0;
+
+        printf("[INFO] Starting adaptive Shapley for %s (antithetic pairs, up to %ld permutations, %d threads)\n",
+               fn->name, 2 * max_pairs, num_threads);
+        if (ci_width > 0.0)
+            printf("[INFO] Target: 95%% CI half-width <= %g\n", ci_width);
+        if (top_k > 0)
+            printf("[INFO] Target: top-%d set unchanged for %d checks\n", top_k, SHAPLEY_STABLE_CHECKS);
+
+        while (!done && task.end < max_pairs)
+        {
+            long step = task.end / 4 > SHAPLEY_MIN_PAIRS ? task.end / 4 : SHAPLEY_MIN_PAIRS;
+            task.begin = task.end;
+            task.end = task.begin + step < max_pairs ? task.begin + step : max_pairs;
+
+            parallel_run(shapley_sample_worker, &task);
+            parallel_run(shapley_reduce_worker, &task);
+
+            double half = max_ci_half_width(totals, sumsq, n, task.end);
+            done = ci_width > 0.0 && half <= ci_width;
+
+            if (top_k > 0 && top && ranks)
+            {
+                int *prev = top + top_k;
+                memcpy(prev, top, top_k * sizeof(int));
+                top_k_nodes(totals, n, top_k, ranks, top);
+                stable = (stable >= 0 && memcmp(prev, top, top_k * sizeof(int)) == 0) ? stable + 1 : 0;
+                done = done || stable >= SHAPLEY_STABLE_CHECKS;
+            }
+
+            printf("[INFO] %ld permutations: max CI half-width %.4f", 2 * task.end, half);
+            if (top_k > 0)
+                printf(", top-%d stable for %d checks", top_k, stable);
+            printf("\n");
+        }
+
+        printf("[%s] Adaptive sampling %s after %ld permutations\n", done ? "OK" : "WARN",
+               done ? "reached its target" : "hit the -i budget", 2 * task.end);
+        free(top);
+        free(ranks);
+        divisor = 2.0 * (double)task.end;
     }
 
     for (size_t i = 0; i < n; i++)
     {
-        shapley_values[i] /= iterations;
+        shapley_values[i] = (double)totals[i] / divisor;
     }
 
-    free(permutation);
+    for (int t = 0; t < num_threads; ++t)
+    {
+        shapley_buffers_free(&buffers[t]);
+    }
+    free(buffers);
+    free(totals);
+    free(sumsq);
     printf("[OK] Shapley calculation completed\n");
     return shapley_values;
 }
@@ -241,7 +799,142 @@ static int compare_node_values(const void *a, const void *b)
     double diff = nb->shapley_value - na->shapley_value;
     if (diff > 0) return 1;
     if (diff < 0) return -1;
-    return 0;
+    return na->node_id - nb->node_id;
+}
+
+#define RD_UNDECIDED 0
+#define RD_REMOVED 1
+#define RD_KEPT 2
+#define RD_SERIAL_FRONTIER 4096
+
+typedef struct
+{
+    graph *g;
+    const int *rank;
+    const int *by_rank;
+    unsigned char *state;
+    int *pending;
+    int *frontier[2];
+    long size[2];
+    int rounds;
+} reverse_delete_task;
+
+/*
+ * Reverse delete removes a node iff none of its neighbours was removed
+ * before it, i.e. the removed nodes are the lexicographically-first
+ * maximal independent set in deletion order, and the rounds below find
+ * the same set as the sequential loop. pending[u] counts the earlier
+ * neighbours of u not yet known to be kept. Each round scans the rows of
+ * the nodes decided in the previous one: a removed node makes its later
+ * neighbours kept at once, a kept one decrements their counts, and a node
+ * whose count reaches zero is removed. Every node is decided and scanned
+ * exactly once, so the total work is O(n + m). Once the frontier is too
+ * small to be worth a round of barriers, thread 0 finishes the remaining
+ * nodes in deletion order. A self-loop can never be covered by the other
+ * endpoint, so such a node is kept, as in the serial loop.
+ */
+static int reverse_delete_decide(const reverse_delete_task *task, int u)
+{
+    graph *g = task->g;
+
+    for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
+    {
+        int v = g->col_ind[j];
+        if (v == u || (task->rank[v] < task->rank[u] && task->state[v] == RD_REMOVED))
+            return RD_KEPT;
+    }
+    return RD_REMOVED;
+}
+
+static void reverse_delete_push(reverse_delete_task *task, int slot_set, int u)
+{
+    long slot = __atomic_fetch_add(&task->size[slot_set], 1, __ATOMIC_RELAXED);
+    task->frontier[slot_set][slot] = u;
+}
+
+static int reverse_delete_claim(reverse_delete_task *task, int u, unsigned char decision)
+{
+    unsigned char undecided = RD_UNDECIDED;
+    return __atomic_compare_exchange_n(&task->state[u], &undecided, decision, 0, __ATOMIC_RELAXED,
+                                       __ATOMIC_RELAXED);
+}
+
+static void reverse_delete_worker(int thread_id, int num_threads, void *arg)
+{
+    reverse_delete_task *task = (reverse_delete_task *)arg;
+    graph *g = task->g;
+    long begin, end;
+
+    parallel_block(g->num_nodes, thread_id, num_threads, &begin, &end);
+    for (long idx = begin; idx < end; ++idx)
+    {
+        int u = (int)idx;
+        int earlier = 0, self_loop = 0;
+        for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
+        {
+            int v = g->col_ind[j];
+            self_loop |= v == u;
+            earlier += task->rank[v] < task->rank[u];
+        }
+        task->pending[u] = earlier;
+        if (self_loop || earlier == 0)
+        {
+            task->state[u] = self_loop ? RD_KEPT : RD_REMOVED;
+            reverse_delete_push(task, 0, u);
+        }
+    }
+    parallel_barrier();
+
+    for (int round = 0;; ++round)
+    {
+        int cur = round & 1;
+        const int *frontier = task->frontier[cur];
+        parallel_block(task->size[cur], thread_id, num_threads, &begin, &end);
+
+        for (long idx = begin; idx < end; ++idx)
+        {
+            int u = frontier[idx];
+            int removed = task->state[u] == RD_REMOVED;
+            for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
+            {
+                int v = g->col_ind[j];
+                if (task->rank[v] <= task->rank[u])
+                    continue;
+                int claimed;
+                if (removed)
+                    claimed = reverse_delete_claim(task, v, RD_KEPT);
+                else
+                    claimed = __atomic_sub_fetch(&task->pending[v], 1, __ATOMIC_RELAXED) == 0 &&
+                              reverse_delete_claim(task, v, RD_REMOVED);
+                if (claimed)
+                    reverse_delete_push(task, cur ^ 1, v);
+            }
+        }
+        parallel_barrier();
+
+        /* Nothing reads size[cur] past the start of the round, and the
+         * next round pushes into it straight away, so it is cleared
+         * before the barrier. */
+        long following = task->size[cur ^ 1];
+        if (thread_id == 0)
+            task->size[cur] = 0;
+        parallel_barrier();
+
+        if (following < RD_SERIAL_FRONTIER)
+        {
+            if (thread_id == 0)
+            {
+                task->rounds = round + 1;
+                for (int i = 0; following > 0 && i < g->num_nodes; ++i)
+                {
+                    int u = task->by_rank[i];
+                    if (task->state[u] == RD_UNDECIDED)
+                        task->state[u] = (unsigned char)reverse_delete_decide(task, u);
+                }
+            }
+            break;
+        }
+    }
 }
 
 
@@ -271,85 +964,123 @@ unsigned char *build_security_set_from_shapley(graph *g, double *shapley_values)
 
     printf("[INFO] Attempting minimization (reverse delete order)...\n");
     size_t removed_count = 0;
-
-    for (size_t i = n; i > 0; i--)
+    int num_threads = parallel_num_threads();
+    int *rank = malloc(n * sizeof(int));
+    unsigned char *state = calloc(n, sizeof(unsigned char));
+    int *pending = malloc(n * sizeof(int));
+    int *frontier = malloc(n * sizeof(int));
+    int *following = malloc(n * sizeof(int));
+    int *by_rank = malloc(n * sizeof(int));
+
+    if (num_threads > 1 && rank && state && pending && frontier && following && by_rank)
     {
-        size_t index = i - 1;
-        int candidate_node = sorted_nodes[index].node_id;
-
-        security_set[candidate_node] = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            rank[sorted_nodes[i].node_id] = (int)(n - 1 - i);
+            by_rank[n - 1 - i] = sorted_nodes[i].node_id;
+        }
 
-        int still_covered = 1;
-        int start = g->row_ptr[candidate_node];
-        int end = g->row_ptr[candidate_node + 1];
+        reverse_delete_task task = {g, rank, by_rank, state, pending, {frontier, following}, {0, 0}, 0};
+        parallel_run(reverse_delete_worker, &task);
 
-        for (int j = start; j < end; ++j)
+        for (size_t i = 0; i < n; i++)
         {
-            int neighbor = g->col_ind[j];
-            if (security_set[neighbor] == 0)
+            if (state[i] == RD_REMOVED)
             {
-                still_covered = 0;
-                break;
+                security_set[i] = 0;
+                removed_count++;
             }
         }
-
-        if (still_covered)
-        {
-            removed_count++;
-        }
-        else
+        printf("[INFO] Parallel reverse delete: %d parallel rounds on %d threads\n", task.rounds, num_threads);
+    }
+    else
+    {
+        for (size_t i = n; i > 0; i--)
         {
+            size_t index = i - 1;
+            int candidate_node = sorted_nodes[index].node_id;
+
+            security_set[candidate_node] = 0;
+
+            int still_covered = 1;
+            eidx_t start = g->row_ptr[candidate_node];
+            eidx_t end = g->row_ptr[candidate_node + 1];
+
+            for (eidx_t j = start; j < end; ++j)
+            {
+                int neighbor = g->col_ind[j];
+                if (security_set[neighbor] == 0)
+                {
+                    still_covered = 0;
+                    break;
+                }
+            }
+
+            if (still_covered)
+            {
+                removed_count++;
+            }
+            else
+            {
 
-            security_set[candidate_node] = 1;
+                security_set[candidate_node] = 1;
+            }
         }
     }
 
+    free(rank);
+    free(state);
+    free(pending);
+    free(frontier);
+    free(following);
+    free(by_rank);
+
     printf("[INFO] Nodes removed: %zu. Final set size: %zu\n", removed_count, n - removed_count);
 
     printf("[INFO] Final minimality check (using is_minimal logic)...\n");
 
-    int changed = 1;
+    /*
+     * private_count[u] is the number of u's neighbours outside the set, so a
+     * member with a zero count covers no edge alone. Removing u only raises
+     * its neighbours' counts, so no node becomes removable later and one
+     * ascending sweep removes exactly what repeated full rescans would.
+     */
     int extra_removed = 0;
-
-    while (changed)
+    int *private_count = calloc(n, sizeof(int));
+    if (!private_count)
     {
-        changed = 0;
-        unsigned char *has_private = calloc(n, sizeof(unsigned char));
+        fprintf(stderr, "Error: Memory allocation failed in build_security_set_from_shapley\n");
+        free(sorted_nodes);
+        return security_set;
+    }
 
-        for (size_t u = 0; u < n; ++u)
+    for (size_t u = 0; u < n; ++u)
+    {
+        if (!security_set[u])
+            continue;
+        for (eidx_t k = g->row_ptr[u]; k < g->row_ptr[u + 1]; ++k)
         {
-            for (int k = g->row_ptr[u]; k < g->row_ptr[u + 1]; ++k)
-            {
-                int v = g->col_ind[k];
-                if ((int)u >= v)
-                    continue;
-
-                if (security_set[u] && !security_set[v])
-                {
-                    has_private[u] = 1;
-                }
-                else if (!security_set[u] && security_set[v])
-                {
-                    has_private[v] = 1;
-                }
-            }
+            private_count[u] += !security_set[g->col_ind[k]];
         }
+    }
 
-        for (size_t i = 0; i < n; i++)
+    for (size_t i = 0; i < n; i++)
+    {
+        if (security_set[i] && private_count[i] == 0)
         {
-            if (security_set[i] && !has_private[i])
+            security_set[i] = 0;
+            extra_removed++;
+            printf("  Removed node %d (no private edge)\n", (int)i);
+
+            for (eidx_t k = g->row_ptr[i]; k < g->row_ptr[i + 1]; ++k)
             {
-                security_set[i] = 0;
-                extra_removed++;
-                changed = 1;
-                printf("  Removed node %d (no private edge)\n", (int)i);
-                break;
+                private_count[g->col_ind[k]]++;
             }
         }
-
-        free(has_private);
     }
 
+    free(private_count);
+
     if (extra_removed > 0)
     {
         printf("[INFO] Removed %d additional nodes to ensure minimality\n", extra_removed);
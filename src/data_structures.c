@@ -3,15 +3,19 @@
 #include <inttypes.h>
 #include <string.h>
 #include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "../include/data_structures.h"
+#include "../include/bitset.h"
+#include "../include/graph_coloring.h"
+#include "../include/sell_matrix.h"
+#include "../include/graph_reorder.h"
+#include "../include/rng.h"
 
 
-typedef struct {
-    int u;
-    int v;
-} edge_t;
-
-graph *create_graph(int num_nodes, int num_edges)
+graph *create_graph(int num_nodes, eidx_t num_edges)
 {
     if (num_nodes == 0)
         return NULL;
@@ -22,9 +26,11 @@ graph *create_graph(int num_nodes, int num_edges)
 
     g->num_nodes = num_nodes;
     g->num_edges = num_edges;
+    g->mapping = NULL;
+    g->mapping_size = 0;
 
-    g->row_ptr = (int *)calloc((num_nodes + 1), sizeof(int));
-    g->col_ind = (int *)malloc(num_edges * sizeof(int));
+    g->row_ptr = (eidx_t *)calloc((size_t)num_nodes + 1, sizeof(eidx_t));
+    g->col_ind = (int *)malloc((size_t)num_edges * sizeof(int));
 
     if (!g->row_ptr || !g->col_ind)
     {
@@ -39,6 +45,12 @@ void free_graph(graph *g)
 {
     if (!g)
         return;
+    if (g->mapping)
+    {
+        munmap(g->mapping, g->mapping_size);
+        free(g);
+        return;
+    }
     if (g->row_ptr)
         free(g->row_ptr);
     if (g->col_ind)
@@ -50,13 +62,13 @@ void print_graph(graph *g)
 {
     if (!g)
         return;
-    printf("[INFO] Graph CSR (%d nodes, %d edges)\n", g->num_nodes, g->num_edges);
+    printf("[INFO] Graph CSR (%d nodes, %" PRIeidx " edges)\n", g->num_nodes, g->num_edges);
 
     int limit = g->num_nodes > 10 ? 10 : g->num_nodes;
     for (int i = 0; i < limit; ++i)
     {
         printf("%d: ", i);
-        for (int j = g->row_ptr[i]; j < g->row_ptr[i + 1]; ++j)
+        for (eidx_t j = g->row_ptr[i]; j < g->row_ptr[i + 1]; ++j)
         {
             printf("%d ", g->col_ind[j]);
         }
@@ -65,465 +77,380 @@ void print_graph(graph *g)
 }
 
 
+_Static_assert(sizeof(graph_file_header) == GRAPH_FILE_ALIGN, "graph file header must fill one alignment block");
+
+static uint64_t align_up(uint64_t x)
+{
+    return (x + GRAPH_FILE_ALIGN - 1) & ~(uint64_t)(GRAPH_FILE_ALIGN - 1);
+}
+
+static int write_padding(FILE *f, uint64_t from, uint64_t to)
+{
+    static const char zeros[GRAPH_FILE_ALIGN] = {0};
+    return to == from || fwrite(zeros, 1, to - from, f) == to - from;
+}
+
+void graph_file_header_init(graph_file_header *h, uint64_t num_nodes, uint64_t num_edges)
+{
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, GRAPH_FILE_MAGIC, sizeof(h->magic));
+    h->version = GRAPH_FILE_VERSION;
+    h->endian_tag = GRAPH_FILE_ENDIAN_TAG;
+    h->offset_bytes = sizeof(eidx_t);
+    h->node_bytes = sizeof(int);
+    h->num_nodes = num_nodes;
+    h->num_edges = num_edges;
+    h->row_ptr_offset = align_up(sizeof(*h));
+    h->col_ind_offset = align_up(h->row_ptr_offset + (num_nodes + 1) * h->offset_bytes);
+}
+
+/* filename + ".tmp"; the caller frees it. */
+char *graph_temp_path(const char *filename)
+{
+    size_t len = strlen(filename);
+    char *path = (char *)malloc(len + 5);
+    if (path)
+    {
+        memcpy(path, filename, len);
+        memcpy(path + len, ".tmp", 5);
+    }
+    return path;
+}
+
+/*
+ * The file is written next to the target and renamed over it, so the
+ * target may be the file g is mapped from: the mapping keeps the old
+ * inode alive, and a failed write leaves the target untouched.
+ */
 int save_graph_to_file(graph *g, const char *filename)
 {
     if (!g || !filename)
         return 0;
 
-    FILE *f = fopen(filename, "wb");
+    char *temp = graph_temp_path(filename);
+    FILE *f = temp ? fopen(temp, "wb") : NULL;
     if (!f)
     {
         perror("Error opening file for writing");
+        free(temp);
         return 0;
     }
 
-    fwrite(&g->num_nodes, sizeof(int), 1, f);
-    fwrite(&g->num_edges, sizeof(int), 1, f);
-    fwrite(g->row_ptr, sizeof(int), g->num_nodes + 1, f);
-    fwrite(g->col_ind, sizeof(int), g->num_edges, f);
+    graph_file_header h;
+    graph_file_header_init(&h, (uint64_t)g->num_nodes, (uint64_t)g->num_edges);
+    uint64_t row_ptr_end = h.row_ptr_offset + (h.num_nodes + 1) * h.offset_bytes;
 
-    fclose(f);
-    printf("[OK] Graph saved to %s\n", filename);
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1 &&
+             write_padding(f, sizeof(h), h.row_ptr_offset) &&
+             fwrite(g->row_ptr, h.offset_bytes, h.num_nodes + 1, f) == h.num_nodes + 1 &&
+             write_padding(f, row_ptr_end, h.col_ind_offset) &&
+             fwrite(g->col_ind, h.node_bytes, h.num_edges, f) == h.num_edges;
+
+    ok = fclose(f) == 0 && ok && rename(temp, filename) == 0;
+    if (!ok)
+        unlink(temp);
+    free(temp);
+    if (!ok)
+    {
+        fprintf(stderr, "Error: Failed to write graph to %s\n", filename);
+        return 0;
+    }
+    printf("[OK] Graph saved to %s (binary CSR, %d nodes, %" PRIeidx " edges)\n", filename, g->num_nodes,
+           g->num_edges);
     return 1;
 }
 
-graph *load_graph_from_file(const char *filename)
+int is_binary_graph_file(const char *filename)
 {
-    if (!filename)
-        return NULL;
-
+    char magic[8];
     FILE *f = fopen(filename, "rb");
     if (!f)
-        return NULL;
-
-    int num_nodes = 0, num_edges = 0;
-
-    if (fread(&num_nodes, sizeof(int), 1, f) != 1 ||
-        fread(&num_edges, sizeof(int), 1, f) != 1)
-    {
-        fclose(f);
-        return NULL;
-    }
-
-    graph *g = create_graph(num_nodes, num_edges);
-    if (!g)
-    {
-        fclose(f);
-        return NULL;
-    }
-
-    if ((int)fread(g->row_ptr, sizeof(int), num_nodes + 1, f) != num_nodes + 1 ||
-        (int)fread(g->col_ind, sizeof(int), num_edges, f) != num_edges)
-    {
-        free_graph(g);
-        fclose(f);
-        return NULL;
-    }
+        return 0;
 
+    int binary = fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+                 memcmp(magic, GRAPH_FILE_MAGIC, sizeof(magic)) == 0;
     fclose(f);
-    printf("[OK] Graph loaded from %s (%d nodes, %d edges)\n", filename, num_nodes, num_edges);
-    return g;
+    return binary;
 }
 
-int save_graph_to_text(graph *g, const char *filename)
+/*
+ * The mapped arrays are used in place by every engine, so a corrupt file
+ * must be caught here: one linear pass over row_ptr and col_ind.
+ */
+static const char *check_csr_arrays(const graph *g)
 {
-    if (!g || !filename)
-        return 0;
+    if (g->row_ptr[0] != 0 || g->row_ptr[g->num_nodes] != g->num_edges)
+        return "row_ptr does not match edge count";
 
-    FILE *f = fopen(filename, "w");
-    if (!f)
+    for (int u = 0; u < g->num_nodes; ++u)
     {
-        perror("Error opening file for writing");
-        return 0;
+        if (g->row_ptr[u + 1] < g->row_ptr[u])
+            return "row_ptr is not monotone";
     }
 
-    int unique_edges = g->num_edges / 2;
-    fprintf(f, "%d %d\n", g->num_nodes, unique_edges);
-
-    for (int u = 0; u < g->num_nodes; ++u)
+    for (eidx_t k = 0; k < g->num_edges; ++k)
     {
-        for (int j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
-        {
-            int v = g->col_ind[j];
-            if (u < v)
-            {
-                fprintf(f, "%d %d\n", u, v);
-            }
-        }
+        if ((unsigned int)g->col_ind[k] >= (unsigned int)g->num_nodes)
+            return "neighbour id out of range";
     }
-
-    fclose(f);
-    printf("[OK] Graph saved to %s (text format)\n", filename);
-    return 1;
+    return NULL;
 }
 
-graph *load_graph_from_text(const char *filename)
+/*
+ * Maps the file privately and points row_ptr/col_ind into the mapping, so
+ * nothing is copied; the validation pass still reads both arrays once, so
+ * loading is O(n + m).
+ */
+graph *load_graph_from_file(const char *filename)
 {
     if (!filename)
         return NULL;
 
-    FILE *f = fopen(filename, "r");
-    if (!f)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
         return NULL;
 
-    int num_nodes = 0, num_unique_edges = 0;
-    if (fscanf(f, "%d %d", &num_nodes, &num_unique_edges) != 2)
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(graph_file_header))
     {
-        fclose(f);
+        close(fd);
         return NULL;
     }
 
-    int *degrees = (int *)calloc(num_nodes, sizeof(int));
-    edge_t *edges = (edge_t *)malloc(num_unique_edges * sizeof(edge_t));
-    if (!degrees || !edges)
+    size_t size = (size_t)st.st_size;
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
     {
-        free(degrees);
-        free(edges);
-        fclose(f);
+        perror("Error mapping graph file");
         return NULL;
     }
 
-    for (int i = 0; i < num_unique_edges; ++i)
-    {
-        int u, v;
-        if (fscanf(f, "%d %d", &u, &v) != 2)
-        {
-            free(degrees);
-            free(edges);
-            fclose(f);
-            return NULL;
-        }
-        edges[i].u = u;
-        edges[i].v = v;
-        degrees[u]++;
-        degrees[v]++;
-    }
-    fclose(f);
+    const graph_file_header *h = (const graph_file_header *)map;
+    const char *error = NULL;
+
+    if (memcmp(h->magic, GRAPH_FILE_MAGIC, sizeof(h->magic)) != 0)
+        error = "bad magic";
+    else if (h->version != GRAPH_FILE_VERSION)
+        error = "unsupported version";
+    else if (h->endian_tag != GRAPH_FILE_ENDIAN_TAG)
+        error = "byte order differs from this machine";
+    else if (h->offset_bytes != sizeof(eidx_t))
+        error = h->offset_bytes > sizeof(eidx_t) ? "64-bit edge offsets need a WIDE=1 build"
+                                                  : "32-bit edge offsets cannot be mapped by a WIDE=1 build";
+    else if (h->node_bytes != sizeof(int))
+        error = "node id width differs from this build";
+    else if (h->num_nodes == 0 || h->num_nodes >= INT32_MAX || h->num_edges > (uint64_t)EIDX_MAX ||
+             h->row_ptr_offset % GRAPH_FILE_ALIGN != 0 || h->col_ind_offset % GRAPH_FILE_ALIGN != 0)
+        error = "inconsistent header";
+    /* Offsets and counts come from the file: compare each length against
+     * the room left after its offset so nothing can wrap, and keep the
+     * header, row_ptr and col_ind in that order without overlap. */
+    else if (h->row_ptr_offset < sizeof(*h) || h->row_ptr_offset > size ||
+             h->num_nodes + 1 > (size - h->row_ptr_offset) / h->offset_bytes ||
+             h->col_ind_offset < h->row_ptr_offset + (h->num_nodes + 1) * h->offset_bytes ||
+             h->col_ind_offset > size || h->num_edges > (size - h->col_ind_offset) / h->node_bytes)
+        error = "truncated file or overlapping sections";
 
-    int total_edges = num_unique_edges * 2;
-    graph *g = create_graph(num_nodes, total_edges);
-    if (!g)
-    {
-        free(degrees);
-        free(edges);
-        return NULL;
-    }
-
-    g->row_ptr[0] = 0;
-    for (int i = 0; i < num_nodes; ++i)
+    graph *g = NULL;
+    if (!error)
     {
-        g->row_ptr[i + 1] = g->row_ptr[i] + degrees[i];
+        g = (graph *)malloc(sizeof(graph));
+        if (!g)
+            error = "out of memory";
     }
-
-    int *current_pos = (int *)malloc(num_nodes * sizeof(int));
-    for (int i = 0; i < num_nodes; ++i)
+    if (!error)
     {
-        current_pos[i] = g->row_ptr[i];
+        g->num_nodes = (int)h->num_nodes;
+        g->num_edges = (eidx_t)h->num_edges;
+        g->row_ptr = (eidx_t *)((char *)map + h->row_ptr_offset);
+        g->col_ind = (int *)((char *)map + h->col_ind_offset);
+        g->mapping = map;
+        g->mapping_size = size;
+
+        error = check_csr_arrays(g);
+        if (error)
+        {
+            free(g);
+            g = NULL;
+        }
     }
 
-    for (int i = 0; i < num_unique_edges; ++i)
+    if (error)
     {
-        int u = edges[i].u;
-        int v = edges[i].v;
-        g->col_ind[current_pos[u]++] = v;
-        g->col_ind[current_pos[v]++] = u;
+        fprintf(stderr, "Error: %s is not a valid binary graph (%s)\n", filename, error);
+        munmap(map, size);
+        return NULL;
     }
 
-    free(current_pos);
-    free(degrees);
-    free(edges);
-
-    printf("[OK] Graph loaded from %s (%d nodes, %d edges)\n", filename, num_nodes, total_edges);
+    printf("[OK] Graph mapped from %s (%d nodes, %" PRIeidx " edges)\n", filename, g->num_nodes, g->num_edges);
     return g;
 }
 
-
-static void shuffle_array(int *array, int n)
+graph *load_graph(const char *filename)
 {
-    for (int i = n - 1; i > 0; i--)
-    {
-        int j = rand() % (i + 1);
-        int temp = array[i];
-        array[i] = array[j];
-        array[j] = temp;
-    }
+    if (is_binary_graph_file(filename))
+        return load_graph_from_file(filename);
+    return load_graph_from_text(filename);
 }
 
-static int has_edge_partial(graph *g, int u, int v, int current_u_degree)
-{
-    int start = g->row_ptr[u];
-    for (int i = 0; i < current_u_degree; ++i)
-    {
-        if (g->col_ind[start + i] == v)
-            return 1;
-    }
-    return 0;
-}
 
-graph *generate_random_regular(int num_nodes, int degree)
+void init_game(game_system *game, graph *g, const graph_order *order)
 {
-    if ((num_nodes * degree) % 2 != 0 || degree >= num_nodes)
-        return NULL;
-
-    int num_edges = num_nodes * degree;
-    int total_stubs = num_nodes * degree;
-
-    int *stubs = (int *)malloc(total_stubs * sizeof(int));
-    int *current_degree = (int *)calloc(num_nodes, sizeof(int));
-
-    if (!stubs || !current_degree)
-    {
-        free(stubs);
-        free(current_degree);
-        return NULL;
-    }
+    game->g = g;
+    game->order = order;
+    game->num_players = g->num_nodes;
+    game->strategy_bits = bitset_create(game->num_players);
+    game->unsecured_neighbors = (int *)malloc(game->num_players * sizeof(int));
+    game->coloring = NULL;
+    game->sell = NULL;
+    game->partition = NULL;
+    game->num_parts = 0;
+    game->iteration = 0;
 
-    graph *g = NULL;
-    int success = 0;
+    game->rs.regret_out = NULL;
+    game->rs.regret_in = NULL;
+    game->rs.prob_in = NULL;
+    game->rs.samples = NULL;
 
-    while (!success)
+    uint64_t key = rng_stream_key(RNG_STREAM_GAME, 0);
+    for (int i = 0; i < game->num_players; ++i)
     {
-        if (g)
-            free_graph(g);
-        g = create_graph(num_nodes, num_edges);
-        if (!g)
-            break;
-
-        for (int i = 0; i <= num_nodes; ++i)
-            g->row_ptr[i] = i * degree;
-
-        memset(current_degree, 0, num_nodes * sizeof(int));
-
-        int k = 0;
-        for (int i = 0; i < num_nodes; ++i)
-        {
-            for (int j = 0; j < degree; ++j)
-                stubs[k++] = i;
-        }
-
-        shuffle_array(stubs, total_stubs);
-
-        int collision = 0;
-        for (int i = 0; i < total_stubs; i += 2)
-        {
-            int u = stubs[i];
-            int v = stubs[i + 1];
-
-            if (u == v || has_edge_partial(g, u, v, current_degree[u]))
-            {
-                collision = 1;
-                break;
-            }
-
-            g->col_ind[g->row_ptr[u] + current_degree[u]++] = v;
-            g->col_ind[g->row_ptr[v] + current_degree[v]++] = u;
-        }
-
-        if (!collision)
-            success = 1;
+        bitset_assign(game->strategy_bits, i, (int)(rng_counter(key, (uint64_t)graph_order_original(order, i)) >> 63));
     }
 
-    free(stubs);
-    free(current_degree);
-    return g;
+    game_refresh_counters(game);
 }
 
+void free_game(game_system *game)
+{
+    if (game->strategy_bits)
+        free(game->strategy_bits);
+    if (game->unsecured_neighbors)
+        free(game->unsecured_neighbors);
+    free_graph_coloring(game->coloring);
+    free_sell_matrix(game->sell);
+    free(game->partition);
+}
 
-graph *generate_erdos_renyi(int num_nodes, double p) {
-    
-    size_t capacity = num_nodes * 10; 
-    size_t count = 0;
-    edge_t *edge_list = (edge_t *)malloc(capacity * sizeof(edge_t));
-    if(!edge_list) return NULL;
-
-    int *degrees = (int *)calloc(num_nodes, sizeof(int));
-    if(!degrees) { free(edge_list); return NULL; }
-
-
-    for (int i = 0; i < num_nodes; ++i) {
-        for (int j = i + 1; j < num_nodes; ++j) {
-            double r = (double)rand() / (double)RAND_MAX;
-            if (r < p) {
-
-                if (count >= capacity) {
-                    capacity *= 2;
-                    edge_t *temp = realloc(edge_list, capacity * sizeof(edge_t));
-                    if (!temp) {
-                        free(edge_list);
-                        free(degrees);
-                        return NULL;
-                    }
-                    edge_list = temp;
-                }
-                edge_list[count].u = i;
-                edge_list[count].v = j;
-                count++;
-                degrees[i]++;
-                degrees[j]++;
-            }
-        }
-    }
-
-
-    graph *g = create_graph(num_nodes, count * 2);
-    if (!g) {
-        free(edge_list);
-        free(degrees);
-        return NULL;
-    }
-
+void game_refresh_counters(game_system *game)
+{
+    graph *g = game->g;
 
-    g->row_ptr[0] = 0;
-    for (int i = 0; i < num_nodes; ++i) {
-        g->row_ptr[i+1] = g->row_ptr[i] + degrees[i];
-    }
+    game->uncovered_edges = 0;
+    game->redundant_secured = 0;
 
+    for (int u = 0; u < game->num_players; ++u)
+    {
+        int degree = (int)(g->row_ptr[u + 1] - g->row_ptr[u]);
+        int unsecured = degree - bitset_count_row(g, u, game->strategy_bits);
+        game->unsecured_neighbors[u] = unsecured;
 
-    int *current_pos = (int *)malloc(num_nodes * sizeof(int));
-    for (int i = 0; i < num_nodes; ++i) {
-        current_pos[i] = g->row_ptr[i];
+        if (!bitset_test(game->strategy_bits, u))
+            game->uncovered_edges += unsecured;
+        else if (unsecured == 0)
+            game->redundant_secured++;
     }
 
+    game->uncovered_edges /= 2;
+}
 
-    for (size_t i = 0; i < count; ++i) {
-        int u = edge_list[i].u;
-        int v = edge_list[i].v;
-
-        g->col_ind[current_pos[u]++] = v;
-        g->col_ind[current_pos[v]++] = u;
+void game_assign_strategies(game_system *game, const unsigned char *strategies)
+{
+    for (int u = 0; u < game->num_players; ++u)
+    {
+        bitset_assign(game->strategy_bits, u, strategies[u]);
     }
-
-    free(current_pos);
-    free(edge_list);
-    free(degrees);
-
-    return g;
+    game_refresh_counters(game);
 }
 
+void game_set_strategy(game_system *game, int player_id, unsigned char strategy)
+{
+    if (bitset_test(game->strategy_bits, player_id) == strategy)
+        return;
 
-graph *generate_barabasi_albert(int num_nodes, int m) {
-    if (m < 1 || m >= num_nodes) return NULL;
-
-    
-    int init_nodes = m + 1;
-    int approx_edges = (init_nodes * m) / 2 + (num_nodes - init_nodes) * m;
-    
-
-    edge_t *edge_list = (edge_t *)malloc(approx_edges * sizeof(edge_t));
-    int edge_count = 0;
-
-
-    int *repeated_nodes = (int *)malloc(approx_edges * 2 * sizeof(int));
-    int repeated_count = 0;
-
-
-    for (int i = 0; i < init_nodes; ++i) {
-        for (int j = i + 1; j < init_nodes; ++j) {
-            edge_list[edge_count].u = i;
-            edge_list[edge_count].v = j;
-            edge_count++;
+    bitset_assign(game->strategy_bits, player_id, strategy);
 
-            repeated_nodes[repeated_count++] = i;
-            repeated_nodes[repeated_count++] = j;
-        }
+    int own_unsecured = game->unsecured_neighbors[player_id];
+    if (strategy == 1)
+    {
+        game->uncovered_edges -= own_unsecured;
+        if (own_unsecured == 0)
+            game->redundant_secured++;
+    }
+    else
+    {
+        game->uncovered_edges += own_unsecured;
+        if (own_unsecured == 0)
+            game->redundant_secured--;
     }
 
+    int delta = (strategy == 1) ? -1 : 1;
+    graph *g = game->g;
 
-    int *targets = (int *)malloc(m * sizeof(int));
-
-    for (int i = init_nodes; i < num_nodes; ++i) {
-
-        int added = 0;
-        while (added < m) {
-            int r_idx = rand() % repeated_count;
-            int target = repeated_nodes[r_idx];
-            
-
-            int duplicate = 0;
-            for (int k = 0; k < added; ++k) {
-                if (targets[k] == target) {
-                    duplicate = 1;
-                    break;
-                }
-            }
-            if (!duplicate) {
-                targets[added++] = target;
-            }
-        }
-
-
-        for (int k = 0; k < m; ++k) {
-            int target = targets[k];
-            edge_list[edge_count].u = i;
-            edge_list[edge_count].v = target;
-            edge_count++;
+    for (eidx_t k = g->row_ptr[player_id]; k < g->row_ptr[player_id + 1]; ++k)
+    {
+        int v = g->col_ind[k];
+        int before = game->unsecured_neighbors[v];
+        game->unsecured_neighbors[v] = before + delta;
 
-            repeated_nodes[repeated_count++] = i;
-            repeated_nodes[repeated_count++] = target;
+        if (bitset_test(game->strategy_bits, v))
+        {
+            if (before == 0)
+                game->redundant_secured--;
+            else if (before + delta == 0)
+                game->redundant_secured++;
         }
     }
+}
 
-    free(targets);
-    free(repeated_nodes);
-
-
-    int *degrees = (int *)calloc(num_nodes, sizeof(int));
-    for (int i = 0; i < edge_count; ++i) {
-        degrees[edge_list[i].u]++;
-        degrees[edge_list[i].v]++;
-    }
 
-    graph *g = create_graph(num_nodes, edge_count * 2);
-    
+/*
+ * Variant of game_set_strategy() for parallel engines. Concurrent callers
+ * must update pairwise non-adjacent nodes (e.g. one colour class), so a
+ * node's own counter is stable while shared neighbour counters and bitset
+ * words are updated atomically. Global counter changes are accumulated in
+ * the caller's delta and folded in once the parallel phase is over.
+ */
+void game_set_strategy_concurrent(game_system *game, int player_id, unsigned char strategy,
+                                  game_counter_delta *delta)
+{
+    if (bitset_test_relaxed(game->strategy_bits, player_id) == strategy)
+        return;
 
-    g->row_ptr[0] = 0;
-    for (int i = 0; i < num_nodes; ++i) {
-        g->row_ptr[i+1] = g->row_ptr[i] + degrees[i];
-    }
+    bitset_assign_atomic(game->strategy_bits, player_id, strategy);
 
-    int *current_pos = (int *)malloc(num_nodes * sizeof(int));
-    for (int i = 0; i < num_nodes; ++i) {
-        current_pos[i] = g->row_ptr[i];
+    int own_unsecured = __atomic_load_n(&game->unsecured_neighbors[player_id], __ATOMIC_RELAXED);
+    if (strategy == 1)
+    {
+        delta->uncovered_edges -= own_unsecured;
+        if (own_unsecured == 0)
+            delta->redundant_secured++;
     }
-
-    for (int i = 0; i < edge_count; ++i) {
-        int u = edge_list[i].u;
-        int v = edge_list[i].v;
-
-        g->col_ind[current_pos[u]++] = v;
-        g->col_ind[current_pos[v]++] = u;
+    else
+    {
+        delta->uncovered_edges += own_unsecured;
+        if (own_unsecured == 0)
+            delta->redundant_secured--;
     }
 
-    free(current_pos);
-    free(degrees);
-    free(edge_list);
-
-    return g;
-}
-
-
-void init_game(game_system *game, graph *g)
-{
-    game->g = g;
-    game->num_players = g->num_nodes;
-    game->strategies = (unsigned char *)malloc(game->num_players * sizeof(unsigned char));
-    game->iteration = 0;
-
-    game->rs.regrets = NULL;
-    game->rs.probs = NULL;
+    int step = (strategy == 1) ? -1 : 1;
+    graph *g = game->g;
 
-    for (int i = 0; i < game->num_players; ++i)
+    for (eidx_t k = g->row_ptr[player_id]; k < g->row_ptr[player_id + 1]; ++k)
     {
-        game->strategies[i] = rand() % 2;
+        int v = g->col_ind[k];
+        int before = __atomic_fetch_add(&game->unsecured_neighbors[v], step, __ATOMIC_RELAXED);
+        if (bitset_test_relaxed(game->strategy_bits, v))
+        {
+            if (before == 0)
+                delta->redundant_secured--;
+            else if (before + step == 0)
+                delta->redundant_secured++;
+        }
     }
 }
 
-void free_game(game_system *game)
-{
-    if (game->strategies)
-        free(game->strategies);
-}
-
 
 #define INF_DIST_HEAP 1e14
 
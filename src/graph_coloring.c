@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/graph_coloring.h"
+#include "../include/parallel.h"
+#include "../include/rng.h"
+
+/*
+ * Distance-1 colouring with the Jones-Plassmann scheme: every node gets a
+ * fixed pseudo-random priority, and in each round the uncoloured nodes whose
+ * higher-priority neighbours are all coloured take the smallest colour not
+ * used by their neighbours. Two adjacent nodes can never be selected in the
+ * same round, so the result does not depend on the number of threads.
+ */
+
+typedef struct
+{
+    graph *g;
+    int *color;
+    int *pending;
+    long num_pending;
+    unsigned char *ready;
+    int max_degree;
+} jp_round;
+
+static uint64_t node_priority(int u)
+{
+    return rng_mix64((uint64_t)u + 0x9E3779B97F4A7C15ULL);
+}
+
+static int has_priority(int u, int v)
+{
+    uint64_t pu = node_priority(u);
+    uint64_t pv = node_priority(v);
+    return pu > pv || (pu == pv && u > v);
+}
+
+static void jp_select_task(int thread_id, int num_threads, void *arg)
+{
+    jp_round *r = (jp_round *)arg;
+    long begin, end;
+    parallel_block(r->num_pending, thread_id, num_threads, &begin, &end);
+
+    for (long slot = begin; slot < end; ++slot)
+    {
+        int u = r->pending[slot];
+        unsigned char ready = 1;
+
+        for (eidx_t k = r->g->row_ptr[u]; k < r->g->row_ptr[u + 1]; ++k)
+        {
+            int v = r->g->col_ind[k];
+            if (r->color[v] < 0 && has_priority(v, u))
+            {
+                ready = 0;
+                break;
+            }
+        }
+        r->ready[slot] = ready;
+    }
+}
+
+static void jp_color_task(int thread_id, int num_threads, void *arg)
+{
+    jp_round *r = (jp_round *)arg;
+    long begin, end;
+    parallel_block(r->num_pending, thread_id, num_threads, &begin, &end);
+
+    unsigned char *used = (unsigned char *)calloc(r->max_degree + 1, sizeof(unsigned char));
+    if (!used)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in jp_color_task\n");
+        exit(1);
+    }
+
+    for (long slot = begin; slot < end; ++slot)
+    {
+        if (!r->ready[slot])
+            continue;
+
+        int u = r->pending[slot];
+        eidx_t start = r->g->row_ptr[u];
+        eidx_t stop = r->g->row_ptr[u + 1];
+        int degree = (int)(stop - start);
+
+        for (eidx_t k = start; k < stop; ++k)
+        {
+            int c = r->color[r->g->col_ind[k]];
+            if (c >= 0 && c <= degree)
+                used[c] = 1;
+        }
+
+        int c = 0;
+        while (used[c])
+            c++;
+        r->color[u] = c;
+
+        for (eidx_t k = start; k < stop; ++k)
+        {
+            int nc = r->color[r->g->col_ind[k]];
+            if (nc >= 0 && nc <= degree)
+                used[nc] = 0;
+        }
+    }
+
+    free(used);
+}
+
+graph_coloring *compute_graph_coloring(graph *g)
+{
+    int n = g->num_nodes;
+    graph_coloring *c = (graph_coloring *)malloc(sizeof(graph_coloring));
+    int *pending = (int *)malloc(n * sizeof(int));
+    unsigned char *ready = (unsigned char *)malloc(n * sizeof(unsigned char));
+
+    if (!c || !pending || !ready)
+    {
+        free(c);
+        free(pending);
+        free(ready);
+        return NULL;
+    }
+
+    c->color = (int *)malloc(n * sizeof(int));
+    c->class_ptr = NULL;
+    c->class_nodes = (int *)malloc(n * sizeof(int));
+    if (!c->color || !c->class_nodes)
+    {
+        free(pending);
+        free(ready);
+        free_graph_coloring(c);
+        return NULL;
+    }
+
+    jp_round r;
+    r.g = g;
+    r.color = c->color;
+    r.pending = pending;
+    r.num_pending = n;
+    r.ready = ready;
+    r.max_degree = 0;
+
+    for (int u = 0; u < n; ++u)
+    {
+        c->color[u] = -1;
+        pending[u] = u;
+        int degree = (int)(g->row_ptr[u + 1] - g->row_ptr[u]);
+        if (degree > r.max_degree)
+            r.max_degree = degree;
+    }
+
+    int rounds = 0;
+    while (r.num_pending > 0)
+    {
+        parallel_run(jp_select_task, &r);
+        parallel_run(jp_color_task, &r);
+
+        long kept = 0;
+        for (long slot = 0; slot < r.num_pending; ++slot)
+        {
+            if (c->color[pending[slot]] < 0)
+                pending[kept++] = pending[slot];
+        }
+        r.num_pending = kept;
+        rounds++;
+    }
+
+    c->num_colors = 0;
+    for (int u = 0; u < n; ++u)
+    {
+        if (c->color[u] + 1 > c->num_colors)
+            c->num_colors = c->color[u] + 1;
+    }
+
+    c->class_ptr = (int *)calloc(c->num_colors + 1, sizeof(int));
+    if (!c->class_ptr)
+    {
+        free(pending);
+        free(ready);
+        free_graph_coloring(c);
+        return NULL;
+    }
+
+    for (int u = 0; u < n; ++u)
+        c->class_ptr[c->color[u] + 1]++;
+    for (int k = 0; k < c->num_colors; ++k)
+        c->class_ptr[k + 1] += c->class_ptr[k];
+
+    memcpy(pending, c->class_ptr, c->num_colors * sizeof(int));
+    for (int u = 0; u < n; ++u)
+        c->class_nodes[pending[c->color[u]]++] = u;
+
+    printf("[INFO] Graph colouring: %d colours in %d rounds\n", c->num_colors, rounds);
+
+    free(pending);
+    free(ready);
+    return c;
+}
+
+void free_graph_coloring(graph_coloring *c)
+{
+    if (!c)
+        return;
+    free(c->color);
+    free(c->class_ptr);
+    free(c->class_nodes);
+    free(c);
+}
@@ -0,0 +1,1343 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <math.h>
+#include "../include/data_structures.h"
+#include "../include/parallel.h"
+#include "../include/rng.h"
+
+/*
+ * Random d-regular graphs from the configuration model, without restarts.
+ * Stubs are shuffled in parallel with a scatter shuffle: fixed source
+ * blocks of whole rows send their stubs (as node ids) to random buckets,
+ * and each bucket is shuffled on its own, which gives a uniform
+ * permutation. Pairing consecutive stubs is then just a swap of adjacent
+ * entries, after which the shuffle and the scatter are replayed backwards
+ * so every stub finds its partner in its own col_ind slot. All passes
+ * stream through memory or stay inside one bucket; none scatters randomly
+ * over the whole graph. The self-loops and multi-edges left over, O(d^2)
+ * in expectation, are removed by switching each one with a random simple
+ * edge instead of discarding the pairing. Blocks, buckets and the repair
+ * step draw from their own streams, so the graph does not depend on the
+ * thread count.
+ */
+#define REGULAR_SOURCE_BLOCKS 256
+#define REGULAR_BUCKETS 1024
+#define REGULAR_MAX_ROUNDS 1000
+#define REGULAR_SWITCH_ATTEMPTS 100000
+
+typedef struct
+{
+    int num_nodes;
+    int degree;
+    uint64_t round;
+    eidx_t num_stubs;
+    int *perm;
+    eidx_t *offsets;
+    eidx_t *bucket_bounds;
+    eidx_t max_bucket;
+    graph *g;
+    int **defects;
+    long *defect_counts;
+    int *errors;
+} regular_task;
+
+static uint64_t regular_stream(const regular_task *task, int index)
+{
+    return (task->round << 32) | (uint64_t)(index + 1);
+}
+
+static int regular_block_start(const regular_task *task, int block)
+{
+    return (int)((int64_t)task->num_nodes * block / REGULAR_SOURCE_BLOCKS);
+}
+
+static void regular_count_worker(int thread_id, int num_threads, void *arg)
+{
+    regular_task *task = (regular_task *)arg;
+    long begin, end;
+
+    parallel_block(REGULAR_SOURCE_BLOCKS, thread_id, num_threads, &begin, &end);
+    for (int b = (int)begin; b < (int)end; ++b)
+    {
+        eidx_t *counts = &task->offsets[(size_t)b * REGULAR_BUCKETS];
+        eidx_t stubs = (eidx_t)(regular_block_start(task, b + 1) - regular_block_start(task, b)) * task->degree;
+        rng_state rng;
+        rng_init(&rng, RNG_STREAM_GRAPH, regular_stream(task, b));
+
+        for (eidx_t k = 0; k < stubs; ++k)
+            counts[rng_next_bounded(&rng, REGULAR_BUCKETS)]++;
+    }
+}
+
+static void regular_scatter_worker(int thread_id, int num_threads, void *arg)
+{
+    regular_task *task = (regular_task *)arg;
+    eidx_t cursor[REGULAR_BUCKETS];
+    long begin, end;
+
+    parallel_block(REGULAR_SOURCE_BLOCKS, thread_id, num_threads, &begin, &end);
+    for (int b = (int)begin; b < (int)end; ++b)
+    {
+        memcpy(cursor, &task->offsets[(size_t)b * REGULAR_BUCKETS], sizeof(cursor));
+        rng_state rng;
+        rng_init(&rng, RNG_STREAM_GRAPH, regular_stream(task, b));
+
+        for (int u = regular_block_start(task, b); u < regular_block_start(task, b + 1); ++u)
+        {
+            for (int s = 0; s < task->degree; ++s)
+                task->perm[cursor[rng_next_bounded(&rng, REGULAR_BUCKETS)]++] = u;
+        }
+    }
+}
+
+static void regular_shuffle_draws(const regular_task *task, int bucket, eidx_t size, eidx_t *draws)
+{
+    rng_state rng;
+    rng_init(&rng, RNG_STREAM_GRAPH, regular_stream(task, REGULAR_SOURCE_BLOCKS + bucket));
+    for (eidx_t i = size - 1; i > 0; i--)
+        draws[i] = (eidx_t)rng_next_bounded64(&rng, (uint64_t)i + 1);
+}
+
+/*
+ * Shuffles every bucket, pairs consecutive stubs by swapping them, then
+ * undoes the bucket shuffles: afterwards each slot holds the node at the
+ * other end of its stub.
+ */
+static void regular_pair_worker(int thread_id, int num_threads, void *arg)
+{
+    regular_task *task = (regular_task *)arg;
+    eidx_t *draws = (eidx_t *)malloc((size_t)(task->max_bucket + 1) * sizeof(eidx_t));
+    long begin, end;
+
+    if (!draws)
+        task->errors[thread_id] = 1;
+
+    parallel_block(REGULAR_BUCKETS, thread_id, num_threads, &begin, &end);
+    for (int k = (int)begin; draws && k < (int)end; ++k)
+    {
+        int *bucket = &task->perm[task->bucket_bounds[k]];
+        eidx_t size = task->bucket_bounds[k + 1] - task->bucket_bounds[k];
+        regular_shuffle_draws(task, k, size, draws);
+        for (eidx_t i = size - 1; i > 0; i--)
+        {
+            int temp = bucket[i];
+            bucket[i] = bucket[draws[i]];
+            bucket[draws[i]] = temp;
+        }
+    }
+    parallel_barrier();
+
+    long pb, pe;
+    parallel_block(task->num_stubs / 2, thread_id, num_threads, &pb, &pe);
+    for (long i = pb; i < pe; ++i)
+    {
+        int temp = task->perm[2 * i];
+        task->perm[2 * i] = task->perm[2 * i + 1];
+        task->perm[2 * i + 1] = temp;
+    }
+    parallel_barrier();
+
+    for (int k = (int)begin; draws && k < (int)end; ++k)
+    {
+        int *bucket = &task->perm[task->bucket_bounds[k]];
+        eidx_t size = task->bucket_bounds[k + 1] - task->bucket_bounds[k];
+        regular_shuffle_draws(task, k, size, draws);
+        for (eidx_t i = 1; i < size; ++i)
+        {
+            int temp = bucket[i];
+            bucket[i] = bucket[draws[i]];
+            bucket[draws[i]] = temp;
+        }
+    }
+    free(draws);
+}
+
+/*
+ * Replays the scatter to gather every stub's partner into col_ind and
+ * records the row's defects as (u, v) pairs with u <= v: one per
+ * self-loop and one per surplus copy of a multi-edge. Repeats are found
+ * with a small open-addressing table per row, stamped with the row id so
+ * it never needs clearing.
+ */
+static void regular_gather_worker(int thread_id, int num_threads, void *arg)
+{
+    regular_task *task = (regular_task *)arg;
+    graph *g = task->g;
+    int d = task->degree;
+    int bits = 1;
+    while ((1 << bits) < 2 * d)
+        bits++;
+    int mask = (1 << bits) - 1;
+    int *keys = (int *)malloc(((size_t)mask + 1) * sizeof(int));
+    int *stamps = (int *)malloc(((size_t)mask + 1) * sizeof(int));
+    int *copies = (int *)malloc(((size_t)mask + 1) * sizeof(int));
+    eidx_t cursor[REGULAR_BUCKETS];
+    int *defects = NULL;
+    long count = 0, capacity = 0;
+    long begin, end;
+
+    if (!keys || !stamps || !copies)
+    {
+        task->errors[thread_id] = 1;
+        begin = end = 0;
+    }
+    else
+    {
+        for (int i = 0; i <= mask; ++i)
+            stamps[i] = -1;
+        parallel_block(REGULAR_SOURCE_BLOCKS, thread_id, num_threads, &begin, &end);
+    }
+
+    for (int b = (int)begin; b < (int)end; ++b)
+    {
+        memcpy(cursor, &task->offsets[(size_t)b * REGULAR_BUCKETS], sizeof(cursor));
+        rng_state rng;
+        rng_init(&rng, RNG_STREAM_GRAPH, regular_stream(task, b));
+
+        for (int u = regular_block_start(task, b); u < regular_block_start(task, b + 1); ++u)
+        {
+            int *row = &g->col_ind[(eidx_t)u * d];
+            for (int s = 0; s < d; ++s)
+                row[s] = task->perm[cursor[rng_next_bounded(&rng, REGULAR_BUCKETS)]++];
+
+            for (int s = 0; s < d; ++s)
+            {
+                int v = row[s];
+                int h = (int)(((uint32_t)v * 0x9E3779B1u) >> (32 - bits));
+                while (stamps[h] == u && keys[h] != v)
+                    h = (h + 1) & mask;
+
+                int defect;
+                if (stamps[h] != u)
+                {
+                    stamps[h] = u;
+                    keys[h] = v;
+                    copies[h] = 1;
+                    defect = 0;
+                }
+                else
+                {
+                    copies[h]++;
+                    defect = v > u || (v == u && copies[h] % 2 == 0);
+                }
+                if (!defect)
+                    continue;
+
+                if (count == capacity)
+                {
+                    capacity = capacity ? capacity * 2 : 64;
+                    int *grown = (int *)realloc(defects, capacity * 2 * sizeof(int));
+                    if (!grown)
+                    {
+                        task->errors[thread_id] = 1;
+                        break;
+                    }
+                    defects = grown;
+                }
+                defects[2 * count] = u;
+                defects[2 * count + 1] = v;
+                count++;
+            }
+        }
+    }
+
+    free(keys);
+    free(stamps);
+    free(copies);
+    task->defects[thread_id] = defects;
+    task->defect_counts[thread_id] = count;
+}
+
+static int row_count(const graph *g, int u, int v)
+{
+    int count = 0;
+    for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
+        count += g->col_ind[j] == v;
+    return count;
+}
+
+/* Replaces one copy of `from` by `to` in row u. */
+static void row_replace(graph *g, int u, int from, int to)
+{
+    eidx_t j = g->row_ptr[u];
+    while (g->col_ind[j] != from)
+        j++;
+    g->col_ind[j] = to;
+}
+
+/*
+ * Removes the defect (x1, x2) by switching it with a random simple edge
+ * (x3, x4) into (x1, x3) and (x2, x4), provided neither exists yet.
+ */
+static int regular_switch(graph *g, int d, eidx_t num_stubs, int x1, int x2, rng_state *rng)
+{
+    for (int attempt = 0; attempt < REGULAR_SWITCH_ATTEMPTS; ++attempt)
+    {
+        eidx_t k = (eidx_t)rng_next_bounded64(rng, (uint64_t)num_stubs);
+        int x3 = (int)(k / d);
+        int x4 = g->col_ind[k];
+
+        if (x3 == x4 || x1 == x3 || x2 == x4 || row_count(g, x1, x3) || row_count(g, x2, x4) ||
+            row_count(g, x3, x4) != 1)
+            continue;
+
+        row_replace(g, x1, x2, x3);
+        row_replace(g, x2, x1, x4);
+        row_replace(g, x3, x4, x1);
+        row_replace(g, x4, x3, x2);
+        return 1;
+    }
+    return 0;
+}
+
+graph *generate_random_regular(int num_nodes, int degree)
+{
+    eidx_t total_stubs = (eidx_t)num_nodes * degree;
+    if (total_stubs % 2 != 0 || degree >= num_nodes || (int64_t)num_nodes * degree > EIDX_MAX)
+        return NULL;
+
+    int num_threads = parallel_num_threads();
+    regular_task task;
+    memset(&task, 0, sizeof(task));
+    task.num_nodes = num_nodes;
+    task.degree = degree;
+    task.num_stubs = total_stubs;
+    task.perm = (int *)malloc((size_t)total_stubs * sizeof(int));
+    task.offsets = (eidx_t *)malloc((size_t)REGULAR_SOURCE_BLOCKS * REGULAR_BUCKETS * sizeof(eidx_t));
+    task.bucket_bounds = (eidx_t *)malloc((REGULAR_BUCKETS + 1) * sizeof(eidx_t));
+    task.defects = (int **)calloc(num_threads, sizeof(int *));
+    task.defect_counts = (long *)calloc(num_threads, sizeof(long));
+    task.errors = (int *)calloc(num_threads, sizeof(int));
+    task.g = create_graph(num_nodes, total_stubs);
+
+    graph *g = task.g;
+    int ok = task.perm && task.offsets && task.bucket_bounds && task.defects && task.defect_counts &&
+             task.errors && g;
+    int success = 0;
+
+    for (int i = 0; ok && i <= num_nodes; ++i)
+        g->row_ptr[i] = (eidx_t)i * degree;
+
+    for (int round = 0; ok && !success && round < REGULAR_MAX_ROUNDS; ++round)
+    {
+        task.round = (uint64_t)round;
+        memset(task.offsets, 0, (size_t)REGULAR_SOURCE_BLOCKS * REGULAR_BUCKETS * sizeof(eidx_t));
+        parallel_run(regular_count_worker, &task);
+
+        eidx_t running = 0;
+        task.max_bucket = 0;
+        for (int k = 0; k < REGULAR_BUCKETS; ++k)
+        {
+            task.bucket_bounds[k] = running;
+            for (int b = 0; b < REGULAR_SOURCE_BLOCKS; ++b)
+            {
+                eidx_t count = task.offsets[(size_t)b * REGULAR_BUCKETS + k];
+                task.offsets[(size_t)b * REGULAR_BUCKETS + k] = running;
+                running += count;
+            }
+            if (running - task.bucket_bounds[k] > task.max_bucket)
+                task.max_bucket = running - task.bucket_bounds[k];
+        }
+        task.bucket_bounds[REGULAR_BUCKETS] = running;
+
+        parallel_run(regular_scatter_worker, &task);
+        parallel_run(regular_pair_worker, &task);
+        parallel_run(regular_gather_worker, &task);
+
+        rng_state rng;
+        rng_init(&rng, RNG_STREAM_GRAPH, regular_stream(&task, REGULAR_SOURCE_BLOCKS + REGULAR_BUCKETS));
+        success = 1;
+        for (int t = 0; t < num_threads; ++t)
+        {
+            ok = ok && !task.errors[t];
+            for (long i = 0; ok && success && i < task.defect_counts[t]; ++i)
+            {
+                int x1 = task.defects[t][2 * i];
+                int x2 = task.defects[t][2 * i + 1];
+                success = regular_switch(g, degree, total_stubs, x1, x2, &rng);
+            }
+            free(task.defects[t]);
+            task.defects[t] = NULL;
+        }
+    }
+
+    free(task.perm);
+    free(task.offsets);
+    free(task.bucket_bounds);
+    free(task.defects);
+    free(task.defect_counts);
+    free(task.errors);
+
+    if (!ok || !success)
+    {
+        free_graph(g);
+        return NULL;
+    }
+    return g;
+}
+
+
+/*
+ * G(n, p) by Batagelj-Brandes geometric skipping: the gap to the next
+ * neighbour above u in row u is Geometric(p), so a row costs one draw per
+ * edge rather than one per pair. Every row has its own RNG stream, so the
+ * graph depends only on the seed, never on the thread count.
+ *
+ * Threads own row ranges balanced by candidate pairs (row u has n - 1 - u).
+ * The CSR is built in two counting passes without an edge list: the first
+ * counts upper-triangle degrees and how many mirrored entries go to each
+ * owner, the second routes the mirrored entries (v, u) into exactly sized
+ * buckets. Each owner then lays out its rows and fills them with the
+ * routed lower neighbours followed by its regenerated upper neighbours,
+ * which leaves every row sorted.
+ */
+typedef struct
+{
+    int num_nodes;
+    double p;
+    double log_q;
+    int *bounds;
+    eidx_t *upper_degree;
+    long *bucket_counts;
+    int **buckets;
+    eidx_t *row_totals;
+    graph *g;
+} erdos_renyi_task;
+
+static inline int er_next(const erdos_renyi_task *task, rng_state *rng, int v)
+{
+    if (task->p >= 1.0)
+        return v + 1;
+
+    double r = 1.0 - rng_next_double(rng);
+    double skip = floor(log(r) / task->log_q);
+    if (skip >= (double)(task->num_nodes - v))
+        return task->num_nodes;
+    return v + 1 + (int)skip;
+}
+
+static void er_count_worker(int thread_id, int num_threads, void *arg)
+{
+    erdos_renyi_task *task = (erdos_renyi_task *)arg;
+    long *counts = &task->bucket_counts[(size_t)thread_id * num_threads];
+    int n = task->num_nodes;
+
+    for (int u = task->bounds[thread_id]; u < task->bounds[thread_id + 1]; ++u)
+    {
+        rng_state rng;
+        rng_init(&rng, RNG_STREAM_GRAPH, (uint64_t)u + 1);
+        eidx_t degree = 0;
+        int owner = thread_id;
+
+        for (int v = er_next(task, &rng, u); v < n; v = er_next(task, &rng, v))
+        {
+            while (v >= task->bounds[owner + 1])
+                owner++;
+            counts[owner]++;
+            degree++;
+        }
+        task->upper_degree[u] = degree;
+    }
+}
+
+static void er_route_worker(int thread_id, int num_threads, void *arg)
+{
+    erdos_renyi_task *task = (erdos_renyi_task *)arg;
+    long *counts = &task->bucket_counts[(size_t)thread_id * num_threads];
+    int **buckets = &task->buckets[(size_t)thread_id * num_threads];
+    int n = task->num_nodes;
+
+    for (int o = thread_id; o < num_threads; ++o)
+        counts[o] = 0;
+
+    for (int u = task->bounds[thread_id]; u < task->bounds[thread_id + 1]; ++u)
+    {
+        rng_state rng;
+        rng_init(&rng, RNG_STREAM_GRAPH, (uint64_t)u + 1);
+        int owner = thread_id;
+
+        for (int v = er_next(task, &rng, u); v < n; v = er_next(task, &rng, v))
+        {
+            while (v >= task->bounds[owner + 1])
+                owner++;
+            buckets[owner][2 * counts[owner]] = v;
+            buckets[owner][2 * counts[owner] + 1] = u;
+            counts[owner]++;
+        }
+    }
+}
+
+static void er_build_worker(int thread_id, int num_threads, void *arg)
+{
+    erdos_renyi_task *task = (erdos_renyi_task *)arg;
+    graph *g = task->g;
+    int begin = task->bounds[thread_id];
+    int end = task->bounds[thread_id + 1];
+    int n = task->num_nodes;
+
+    for (int u = begin; u < end; ++u)
+        g->row_ptr[u + 1] = task->upper_degree[u];
+    for (int t = 0; t <= thread_id; ++t)
+    {
+        const int *entries = task->buckets[(size_t)t * num_threads + thread_id];
+        long count = task->bucket_counts[(size_t)t * num_threads + thread_id];
+        for (long i = 0; i < count; ++i)
+            g->row_ptr[entries[2 * i] + 1]++;
+    }
+
+    eidx_t total = 0;
+    for (int u = begin; u < end; ++u)
+        total += g->row_ptr[u + 1];
+    task->row_totals[thread_id] = total;
+    parallel_barrier();
+
+    eidx_t offset = 0;
+    for (int t = 0; t < thread_id; ++t)
+        offset += task->row_totals[t];
+    for (int u = begin; u < end; ++u)
+    {
+        eidx_t degree = g->row_ptr[u + 1];
+        g->row_ptr[u + 1] = offset;
+        offset += degree;
+    }
+    if (begin == 0)
+        g->row_ptr[0] = 0;
+
+    /* row_ptr[u + 1] serves as the cursor of row u; it ends at row u's end. */
+    for (int t = 0; t <= thread_id; ++t)
+    {
+        const int *entries = task->buckets[(size_t)t * num_threads + thread_id];
+        long count = task->bucket_counts[(size_t)t * num_threads + thread_id];
+        for (long i = 0; i < count; ++i)
+            g->col_ind[g->row_ptr[entries[2 * i] + 1]++] = entries[2 * i + 1];
+    }
+
+    for (int u = begin; u < end; ++u)
+    {
+        rng_state rng;
+        rng_init(&rng, RNG_STREAM_GRAPH, (uint64_t)u + 1);
+        for (int v = er_next(task, &rng, u); v < n; v = er_next(task, &rng, v))
+            g->col_ind[g->row_ptr[u + 1]++] = v;
+    }
+}
+
+/* Splits rows so that every thread gets about the same number of candidate pairs. */
+static void er_partition_rows(int n, int num_threads, int *bounds)
+{
+    int64_t total = (int64_t)n * (n - 1) / 2;
+
+    bounds[0] = 0;
+    for (int t = 1; t < num_threads; ++t)
+    {
+        int64_t target = total / num_threads * t;
+        int lo = bounds[t - 1];
+        int hi = n;
+
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if ((int64_t)mid * (n - 1) - (int64_t)mid * (mid - 1) / 2 < target)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        bounds[t] = lo;
+    }
+    bounds[num_threads] = n;
+}
+
+graph *generate_erdos_renyi(int num_nodes, double p)
+{
+    if (num_nodes <= 0)
+        return NULL;
+
+    int num_threads = parallel_num_threads();
+    size_t num_buckets = (size_t)num_threads * num_threads;
+    erdos_renyi_task task;
+    memset(&task, 0, sizeof(task));
+    task.num_nodes = num_nodes;
+    task.p = p;
+    task.log_q = log1p(-p);
+    task.bounds = (int *)malloc((num_threads + 1) * sizeof(int));
+    task.upper_degree = (eidx_t *)malloc((size_t)num_nodes * sizeof(eidx_t));
+    task.bucket_counts = (long *)calloc(num_buckets, sizeof(long));
+    task.buckets = (int **)calloc(num_buckets, sizeof(int *));
+    task.row_totals = (eidx_t *)calloc(num_threads, sizeof(eidx_t));
+    int ok = task.bounds && task.upper_degree && task.bucket_counts && task.buckets && task.row_totals;
+
+    if (ok && p <= 0.0)
+    {
+        task.g = create_graph(num_nodes, 0);
+        ok = task.g != NULL;
+    }
+    else if (ok)
+    {
+        er_partition_rows(num_nodes, num_threads, task.bounds);
+        parallel_run(er_count_worker, &task);
+
+        int64_t undirected = 0;
+        for (size_t b = 0; b < num_buckets; ++b)
+        {
+            undirected += task.bucket_counts[b];
+            if (task.bucket_counts[b] > 0)
+            {
+                task.buckets[b] = (int *)malloc((size_t)task.bucket_counts[b] * 2 * sizeof(int));
+                ok = ok && task.buckets[b];
+            }
+        }
+
+        if (ok && undirected > EIDX_MAX / 2)
+        {
+            fprintf(stderr, "Error: %" PRId64 " edges need 64-bit offsets (build with WIDE=1)\n", undirected);
+            ok = 0;
+        }
+        if (ok)
+        {
+            task.g = create_graph(num_nodes, (eidx_t)undirected * 2);
+            ok = task.g != NULL;
+        }
+        if (ok)
+        {
+            parallel_run(er_route_worker, &task);
+            parallel_run(er_build_worker, &task);
+        }
+    }
+
+    for (size_t b = 0; task.buckets && b < num_buckets; ++b)
+        free(task.buckets[b]);
+    free(task.buckets);
+    free(task.bucket_counts);
+    free(task.upper_degree);
+    free(task.row_totals);
+    free(task.bounds);
+
+    if (!ok)
+    {
+        free_graph(task.g);
+        return NULL;
+    }
+    return task.g;
+}
+
+
+/*
+ * Barabasi-Albert graphs, generated in parallel after Sanders and Schulz.
+ * The sequential model keeps a list with both endpoints of every edge so
+ * far and lets each new node pick targets uniformly from it. Here the list
+ * is never materialised: slot 2e holds the source of edge e, which follows
+ * from e alone, and slot 2e + 1 its target, which is the slot drawn for e
+ * by a counter-based hash. Resolving a slot therefore follows a short
+ * chain of draws (about two on average) back to a source or to the seed
+ * clique, and any thread can compute any edge. A node that draws the same
+ * target twice redraws that edge with the next counter; the list keeps the
+ * first draw, which only matters in the first few rounds.
+ *
+ * The CSR is assembled as for G(n, p), with each row generating its own
+ * (lower) targets and routing the mirrored entries to their owners.
+ */
+typedef struct
+{
+    int num_nodes;
+    int m;
+    eidx_t clique_edges;
+    uint64_t key;
+    int *bounds;
+    int routing;
+    long *bucket_counts;
+    int **buckets;
+    eidx_t *row_totals;
+    int *errors;
+    graph *g;
+} barabasi_albert_task;
+
+typedef struct
+{
+    int bits;
+    int *keys;
+    int *stamps;
+} target_set;
+
+static int target_set_init(target_set *set, int m)
+{
+    set->bits = 1;
+    while ((1 << set->bits) < 2 * m)
+        set->bits++;
+    set->keys = (int *)malloc(((size_t)1 << set->bits) * sizeof(int));
+    set->stamps = (int *)malloc(((size_t)1 << set->bits) * sizeof(int));
+    for (int i = 0; set->stamps && i < (1 << set->bits); ++i)
+        set->stamps[i] = -1;
+    return set->keys && set->stamps;
+}
+
+static void target_set_free(target_set *set)
+{
+    free(set->keys);
+    free(set->stamps);
+}
+
+/* Adds v to the set of node u; returns 0 if it was already there. */
+static int target_set_insert(target_set *set, int u, int v)
+{
+    int mask = (1 << set->bits) - 1;
+    int h = (int)(((uint32_t)v * 0x9E3779B1u) >> (32 - set->bits));
+
+    while (set->stamps[h] == u)
+    {
+        if (set->keys[h] == v)
+            return 0;
+        h = (h + 1) & mask;
+    }
+    set->stamps[h] = u;
+    set->keys[h] = v;
+    return 1;
+}
+
+static int ba_source(const barabasi_albert_task *task, eidx_t e)
+{
+    if (e < task->clique_edges)
+    {
+        int b = (int)((1.0 + sqrt(1.0 + 8.0 * (double)e)) / 2.0);
+        while ((eidx_t)b * (b - 1) / 2 > e)
+            b--;
+        while ((eidx_t)(b + 1) * b / 2 <= e)
+            b++;
+        return b;
+    }
+    return task->m + 1 + (int)((e - task->clique_edges) / task->m);
+}
+
+/* Slot of the attachment list drawn by edge e on the given attempt. */
+static uint64_t ba_draw(const barabasi_albert_task *task, eidx_t e, int attempt, int source)
+{
+    uint64_t slots = 2 * (uint64_t)(task->clique_edges + (eidx_t)(source - task->m - 1) * task->m);
+    uint64_t x = rng_counter(task->key, (uint64_t)e | ((uint64_t)attempt << 48));
+    return (uint64_t)(((unsigned __int128)x * slots) >> 64);
+}
+
+static int ba_resolve(const barabasi_albert_task *task, uint64_t slot)
+{
+    for (;;)
+    {
+        eidx_t e = (eidx_t)(slot >> 1);
+        int source = ba_source(task, e);
+
+        if ((slot & 1) == 0)
+            return source;
+        if (e < task->clique_edges)
+            return (int)(e - (eidx_t)source * (source - 1) / 2);
+        slot = ba_draw(task, e, 0, source);
+    }
+}
+
+/* Writes the neighbours below u (its own targets) to out; returns how many. */
+static int ba_targets(const barabasi_albert_task *task, int u, target_set *set, int *out)
+{
+    if (u <= task->m)
+    {
+        for (int v = 0; v < u; ++v)
+            out[v] = v;
+        return u;
+    }
+
+    eidx_t first = task->clique_edges + (eidx_t)(u - task->m - 1) * task->m;
+    for (int s = 0; s < task->m; ++s)
+    {
+        int attempt = 0;
+        int v = ba_resolve(task, ba_draw(task, first + s, attempt, u));
+        while (!target_set_insert(set, u, v))
+            v = ba_resolve(task, ba_draw(task, first + s, ++attempt, u));
+        out[s] = v;
+    }
+    return task->m;
+}
+
+/* Insertion sort for short rows, quicksort with median-of-three pivots above that. */
+void sort_adjacency(int *row, int len)
+{
+    while (len > 16)
+    {
+        int a = row[0], b = row[len / 2], c = row[len - 1];
+        int pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+        int i = 0, j = len - 1;
+
+        for (;;)
+        {
+            while (row[i] < pivot)
+                i++;
+            while (row[j] > pivot)
+                j--;
+            if (i >= j)
+                break;
+            int temp = row[i];
+            row[i++] = row[j];
+            row[j--] = temp;
+        }
+
+        /* Recurse into the smaller half, loop on the larger one. */
+        if (j + 1 < len - j - 1)
+        {
+            sort_adjacency(row, j + 1);
+            row += j + 1;
+            len -= j + 1;
+        }
+        else
+        {
+            sort_adjacency(row + j + 1, len - j - 1);
+            len = j + 1;
+        }
+    }
+
+    for (int i = 1; i < len; ++i)
+    {
+        int x = row[i];
+        int j = i - 1;
+        while (j >= 0 && row[j] > x)
+        {
+            row[j + 1] = row[j];
+            j--;
+        }
+        row[j + 1] = x;
+    }
+}
+
+static int owner_of(const int *bounds, int num_threads, int v)
+{
+    int lo = 0, hi = num_threads - 1;
+    while (lo < hi)
+    {
+        int mid = (lo + hi + 1) / 2;
+        if (bounds[mid] <= v)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return lo;
+}
+
+static void ba_route_worker(int thread_id, int num_threads, void *arg)
+{
+    barabasi_albert_task *task = (barabasi_albert_task *)arg;
+    long *counts = &task->bucket_counts[(size_t)thread_id * num_threads];
+    int **buckets = &task->buckets[(size_t)thread_id * num_threads];
+    int *targets = (int *)malloc((size_t)task->m * sizeof(int));
+    target_set set;
+
+    if (!target_set_init(&set, task->m) || !targets)
+    {
+        task->errors[thread_id] = 1;
+        target_set_free(&set);
+        free(targets);
+        return;
+    }
+
+    for (int o = 0; o <= thread_id; ++o)
+        counts[o] = 0;
+
+    for (int u = task->bounds[thread_id]; u < task->bounds[thread_id + 1]; ++u)
+    {
+        int count = ba_targets(task, u, &set, targets);
+        for (int s = 0; s < count; ++s)
+        {
+            int v = targets[s];
+            int o = owner_of(task->bounds, num_threads, v);
+            if (task->routing)
+            {
+                buckets[o][2 * counts[o]] = v;
+                buckets[o][2 * counts[o] + 1] = u;
+            }
+            counts[o]++;
+        }
+    }
+
+    target_set_free(&set);
+    free(targets);
+}
+
+static void ba_build_worker(int thread_id, int num_threads, void *arg)
+{
+    barabasi_albert_task *task = (barabasi_albert_task *)arg;
+    graph *g = task->g;
+    int begin = task->bounds[thread_id];
+    int end = task->bounds[thread_id + 1];
+    target_set set;
+
+    if (!target_set_init(&set, task->m))
+        task->errors[thread_id] = 1;
+
+    for (int u = begin; u < end; ++u)
+        g->row_ptr[u + 1] = u <= task->m ? u : task->m;
+    for (int t = thread_id; t < num_threads; ++t)
+    {
+        const int *entries = task->buckets[(size_t)t * num_threads + thread_id];
+        long count = task->bucket_counts[(size_t)t * num_threads + thread_id];
+        for (long i = 0; i < count; ++i)
+            g->row_ptr[entries[2 * i] + 1]++;
+    }
+
+    eidx_t total = 0;
+    for (int u = begin; u < end; ++u)
+        total += g->row_ptr[u + 1];
+    task->row_totals[thread_id] = total;
+    parallel_barrier();
+
+    eidx_t offset = 0;
+    for (int t = 0; t < thread_id; ++t)
+        offset += task->row_totals[t];
+    for (int u = begin; u < end; ++u)
+    {
+        eidx_t degree = g->row_ptr[u + 1];
+        g->row_ptr[u + 1] = offset;
+        offset += degree;
+    }
+    if (begin == 0)
+        g->row_ptr[0] = 0;
+
+    /* row_ptr[u + 1] serves as the cursor of row u; it ends at row u's end. */
+    for (int u = begin; set.keys && set.stamps && u < end; ++u)
+    {
+        int *row = &g->col_ind[g->row_ptr[u + 1]];
+        int count = ba_targets(task, u, &set, row);
+        sort_adjacency(row, count);
+        g->row_ptr[u + 1] += count;
+    }
+
+    for (int t = thread_id; t < num_threads; ++t)
+    {
+        const int *entries = task->buckets[(size_t)t * num_threads + thread_id];
+        long count = task->bucket_counts[(size_t)t * num_threads + thread_id];
+        for (long i = 0; i < count; ++i)
+            g->col_ind[g->row_ptr[entries[2 * i] + 1]++] = entries[2 * i + 1];
+    }
+    target_set_free(&set);
+}
+
+graph *generate_barabasi_albert(int num_nodes, int m)
+{
+    if (m < 1 || m >= num_nodes)
+        return NULL;
+
+    eidx_t clique_edges = (eidx_t)m * (m + 1) / 2;
+    if ((int64_t)clique_edges + (int64_t)(num_nodes - m - 1) * m > EIDX_MAX / 2)
+        return NULL;
+    eidx_t num_edges = 2 * (clique_edges + (eidx_t)(num_nodes - m - 1) * m);
+
+    int num_threads = parallel_num_threads();
+    size_t num_buckets = (size_t)num_threads * num_threads;
+    barabasi_albert_task task;
+    memset(&task, 0, sizeof(task));
+    task.num_nodes = num_nodes;
+    task.m = m;
+    task.clique_edges = clique_edges;
+    task.key = rng_stream_key(RNG_STREAM_GRAPH, 0);
+    task.bounds = (int *)malloc((num_threads + 1) * sizeof(int));
+    task.bucket_counts = (long *)calloc(num_buckets, sizeof(long));
+    task.buckets = (int **)calloc(num_buckets, sizeof(int *));
+    task.row_totals = (eidx_t *)calloc(num_threads, sizeof(eidx_t));
+    task.errors = (int *)calloc(num_threads, sizeof(int));
+    task.g = create_graph(num_nodes, num_edges);
+    int ok = task.bounds && task.bucket_counts && task.buckets && task.row_totals && task.errors && task.g;
+
+    if (ok)
+    {
+        for (int t = 0; t <= num_threads; ++t)
+            task.bounds[t] = (int)((int64_t)num_nodes * t / num_threads);
+
+        parallel_run(ba_route_worker, &task);
+        for (size_t b = 0; b < num_buckets; ++b)
+        {
+            task.buckets[b] = (int *)malloc(((size_t)task.bucket_counts[b] + 1) * 2 * sizeof(int));
+            ok = ok && task.buckets[b];
+        }
+    }
+    for (int t = 0; ok && t < num_threads; ++t)
+        ok = !task.errors[t];
+
+    if (ok)
+    {
+        task.routing = 1;
+        parallel_run(ba_route_worker, &task);
+        parallel_run(ba_build_worker, &task);
+        for (int t = 0; t < num_threads; ++t)
+            ok = ok && !task.errors[t];
+    }
+
+    for (size_t b = 0; task.buckets && b < num_buckets; ++b)
+        free(task.buckets[b]);
+    free(task.buckets);
+    free(task.bucket_counts);
+    free(task.row_totals);
+    free(task.errors);
+    free(task.bounds);
+
+    if (!ok)
+    {
+        free_graph(task.g);
+        return NULL;
+    }
+    return task.g;
+}
+
+
+/*
+ * Shared CSR builder for generators defined edge by edge. edge(ctx, e)
+ * must be a pure function of e, returning both endpoints. Edges are
+ * produced in batches of GRAPH_STREAM_WINDOW_BYTES worth of routed
+ * entries, so temporary memory stays bounded however many edges there
+ * are: each thread generates a contiguous slice of the batch, groups both
+ * directions of its edges by owning thread, and every owner consumes its
+ * groups in slice order. One sweep counts degrees, a second one fills
+ * col_ind. Rows are then sorted, self-loops and duplicate edges dropped,
+ * and the rows compacted, so the result is a simple graph whatever the
+ * thread count.
+ */
+typedef void (*edge_function)(const void *ctx, eidx_t e, int *u, int *v);
+
+typedef struct
+{
+    int num_nodes;
+    eidx_t num_edges;
+    eidx_t batch_edges;
+    edge_function edge;
+    const void *ctx;
+    int *bounds;
+    int **entries;
+    long *group_starts;
+    eidx_t *row_totals;
+    eidx_t *old_begin;
+    int *errors;
+    graph *g;
+} edge_csr_task;
+
+static void edge_csr_route(edge_csr_task *task, int thread_id, int num_threads, eidx_t batch, int *pairs)
+{
+    eidx_t size = task->batch_edges;
+    if (batch + size > task->num_edges)
+        size = task->num_edges - batch;
+    eidx_t first = batch + size * thread_id / num_threads;
+    eidx_t last = batch + size * (thread_id + 1) / num_threads;
+    long *starts = &task->group_starts[(size_t)thread_id * (num_threads + 1)];
+    int *entries = task->entries[thread_id];
+
+    for (int o = 0; o <= num_threads; ++o)
+        starts[o] = 0;
+    for (eidx_t e = first; e < last; ++e)
+    {
+        int *p = &pairs[2 * (e - first)];
+        task->edge(task->ctx, e, &p[0], &p[1]);
+        starts[owner_of(task->bounds, num_threads, p[0]) + 1]++;
+        starts[owner_of(task->bounds, num_threads, p[1]) + 1]++;
+    }
+    for (int o = 0; o < num_threads; ++o)
+        starts[o + 1] += starts[o];
+
+    long *cursor = &task->group_starts[(size_t)num_threads * (num_threads + 1) + (size_t)thread_id * num_threads];
+    memcpy(cursor, starts, num_threads * sizeof(long));
+    for (eidx_t i = 0; i < last - first; ++i)
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            int row = pairs[2 * i + side];
+            long at = cursor[owner_of(task->bounds, num_threads, row)]++;
+            entries[2 * at] = row;
+            entries[2 * at + 1] = pairs[2 * i + (side ^ 1)];
+        }
+    }
+}
+
+static void edge_csr_worker(int thread_id, int num_threads, void *arg)
+{
+    edge_csr_task *task = (edge_csr_task *)arg;
+    graph *g = task->g;
+    int begin = task->bounds[thread_id];
+    int end = task->bounds[thread_id + 1];
+    int *pairs = (int *)malloc(((size_t)task->batch_edges / num_threads + 1) * 2 * sizeof(int));
+
+    if (!pairs || !task->entries[thread_id])
+        task->errors[thread_id] = 1;
+    parallel_barrier();
+    for (int t = 0; t < num_threads; ++t)
+    {
+        if (task->errors[t])
+        {
+            free(pairs);
+            return;
+        }
+    }
+
+    for (int fill = 0; fill <= 1; ++fill)
+    {
+        for (eidx_t batch = 0; batch < task->num_edges; batch += task->batch_edges)
+        {
+            edge_csr_route(task, thread_id, num_threads, batch, pairs);
+            parallel_barrier();
+
+            /* row_ptr[u + 1] holds the degree while counting and the cursor of row u while filling. */
+            for (int t = 0; t < num_threads; ++t)
+            {
+                const long *starts = &task->group_starts[(size_t)t * (num_threads + 1)];
+                const int *entries = task->entries[t];
+                for (long i = starts[thread_id]; i < starts[thread_id + 1]; ++i)
+                {
+                    if (fill)
+                        g->col_ind[g->row_ptr[entries[2 * i] + 1]++] = entries[2 * i + 1];
+                    else
+                        g->row_ptr[entries[2 * i] + 1]++;
+                }
+            }
+            parallel_barrier();
+        }
+
+        if (!fill)
+        {
+            eidx_t total = 0;
+            for (int u = begin; u < end; ++u)
+                total += g->row_ptr[u + 1];
+            task->row_totals[thread_id] = total;
+            parallel_barrier();
+
+            eidx_t offset = 0;
+            for (int t = 0; t < thread_id; ++t)
+                offset += task->row_totals[t];
+            for (int u = begin; u < end; ++u)
+            {
+                eidx_t degree = g->row_ptr[u + 1];
+                g->row_ptr[u + 1] = offset;
+                offset += degree;
+            }
+            if (begin == 0)
+                g->row_ptr[0] = 0;
+            parallel_barrier();
+        }
+    }
+    free(pairs);
+
+    /* Sort and deduplicate each row, packing the rows to the start of this thread's block. */
+    eidx_t old_end = g->row_ptr[begin];
+    task->old_begin[thread_id] = old_end;
+    parallel_barrier();
+
+    eidx_t packed = task->old_begin[thread_id];
+    for (int u = begin; u < end; ++u)
+    {
+        eidx_t old_start = old_end;
+        old_end = g->row_ptr[u + 1];
+        int *row = &g->col_ind[old_start];
+        int len = (int)(old_end - old_start);
+        int kept = 0;
+
+        sort_adjacency(row, len);
+        for (int i = 0; i < len; ++i)
+        {
+            if (row[i] != u && (kept == 0 || g->col_ind[packed + kept - 1] != row[i]))
+            {
+                g->col_ind[packed + kept] = row[i];
+                kept++;
+            }
+        }
+        packed += kept;
+        g->row_ptr[u + 1] = kept;
+    }
+    task->row_totals[thread_id] = packed - task->old_begin[thread_id];
+    parallel_barrier();
+
+    eidx_t offset = 0;
+    for (int t = 0; t < thread_id; ++t)
+        offset += task->row_totals[t];
+    for (int u = begin; u < end; ++u)
+    {
+        offset += g->row_ptr[u + 1];
+        g->row_ptr[u + 1] = offset;
+    }
+    parallel_barrier();
+
+    /* Blocks only move left, so moving them in order never overwrites unread data. */
+    if (thread_id == 0)
+    {
+        eidx_t to = 0;
+        for (int t = 0; t < num_threads; ++t)
+        {
+            memmove(&g->col_ind[to], &g->col_ind[task->old_begin[t]], (size_t)task->row_totals[t] * sizeof(int));
+            to += task->row_totals[t];
+        }
+    }
+}
+
+static graph *build_csr_from_edges(int num_nodes, eidx_t num_edges, edge_function edge, const void *ctx)
+{
+    if (num_nodes <= 0 || num_edges < 0 || num_edges > EIDX_MAX / 2)
+        return NULL;
+
+    int num_threads = parallel_num_threads();
+    edge_csr_task task;
+    memset(&task, 0, sizeof(task));
+    task.num_nodes = num_nodes;
+    task.num_edges = num_edges;
+    task.batch_edges = (eidx_t)(GRAPH_STREAM_WINDOW_BYTES / (4 * sizeof(int)));
+    if (task.batch_edges > num_edges)
+        task.batch_edges = num_edges > 0 ? num_edges : 1;
+    task.edge = edge;
+    task.ctx = ctx;
+    task.bounds = (int *)malloc((num_threads + 1) * sizeof(int));
+    task.entries = (int **)calloc(num_threads, sizeof(int *));
+    task.group_starts = (long *)malloc((size_t)num_threads * (2 * num_threads + 1) * sizeof(long));
+    task.row_totals = (eidx_t *)calloc(num_threads, sizeof(eidx_t));
+    task.old_begin = (eidx_t *)calloc(num_threads, sizeof(eidx_t));
+    task.errors = (int *)calloc(num_threads, sizeof(int));
+    task.g = create_graph(num_nodes, 2 * num_edges);
+    int ok = task.bounds && task.entries && task.group_starts && task.row_totals && task.old_begin &&
+             task.errors && task.g;
+
+    if (ok)
+    {
+        for (int t = 0; t <= num_threads; ++t)
+            task.bounds[t] = (int)((int64_t)num_nodes * t / num_threads);
+        for (int t = 0; t < num_threads; ++t)
+            task.entries[t] = (int *)malloc(((size_t)task.batch_edges / num_threads + 1) * 4 * sizeof(int));
+
+        parallel_run(edge_csr_worker, &task);
+        for (int t = 0; t < num_threads; ++t)
+            ok = ok && !task.errors[t];
+    }
+
+    for (int t = 0; task.entries && t < num_threads; ++t)
+        free(task.entries[t]);
+    free(task.entries);
+    free(task.group_starts);
+    free(task.row_totals);
+    free(task.old_begin);
+    free(task.errors);
+    free(task.bounds);
+
+    if (!ok)
+    {
+        free_graph(task.g);
+        return NULL;
+    }
+
+    graph *g = task.g;
+    g->num_edges = g->row_ptr[num_nodes];
+    int *shrunk = (int *)realloc(g->col_ind, ((size_t)g->num_edges + 1) * sizeof(int));
+    if (shrunk)
+        g->col_ind = shrunk;
+    return g;
+}
+
+/*
+ * R-MAT (Graph500 Kronecker) graphs: each edge descends `scale` levels of
+ * the adjacency matrix, picking a quadrant with probabilities a, b, c, d,
+ * using 16 bits of a counter-based hash per level. Vertex ids are then
+ * scrambled by an affine bijection modulo 2^scale, as Graph500 scrambles
+ * them, so hubs are not all clustered at small ids; an edge landing outside [0, n) when
+ * n is not a power of two is redrawn.
+ */
+#define RMAT_A 0.57
+#define RMAT_B 0.19
+#define RMAT_C 0.19
+
+typedef struct
+{
+    int num_nodes;
+    int scale;
+    uint64_t key;
+    uint64_t scramble;
+    uint64_t shift;
+    uint32_t thresholds[3];
+} rmat_params;
+
+static void rmat_edge(const void *ctx, eidx_t e, int *u, int *v)
+{
+    const rmat_params *p = (const rmat_params *)ctx;
+    uint64_t mask = ((uint64_t)1 << p->scale) - 1;
+
+    for (uint64_t attempt = 0;; ++attempt)
+    {
+        uint64_t row = 0, col = 0, bits = 0;
+        for (int level = 0; level < p->scale; ++level)
+        {
+            if (level % 4 == 0)
+                bits = rng_counter(p->key, ((uint64_t)e << 16) | (attempt << 4) | (uint64_t)(level / 4));
+            uint32_t r = (uint32_t)(bits & 0xFFFF);
+            bits >>= 16;
+            int quadrant = (r >= p->thresholds[0]) + (r >= p->thresholds[1]) + (r >= p->thresholds[2]);
+            row = (row << 1) | (uint64_t)(quadrant >> 1);
+            col = (col << 1) | (uint64_t)(quadrant & 1);
+        }
+        row = (row * p->scramble + p->shift) & mask;
+        col = (col * p->scramble + p->shift) & mask;
+        if (row < (uint64_t)p->num_nodes && col < (uint64_t)p->num_nodes)
+        {
+            *u = (int)row;
+            *v = (int)col;
+            return;
+        }
+    }
+}
+
+graph *generate_rmat(int num_nodes, eidx_t num_edges)
+{
+    if (num_nodes < 2)
+        return NULL;
+
+    rmat_params p;
+    p.num_nodes = num_nodes;
+    p.scale = 1;
+    while (((int64_t)1 << p.scale) < num_nodes)
+        p.scale++;
+    p.key = rng_stream_key(RNG_STREAM_GRAPH, 0);
+    p.scramble = rng_counter(p.key, UINT64_MAX) | 1;
+    p.shift = rng_counter(p.key, UINT64_MAX - 1);
+    p.thresholds[0] = (uint32_t)(RMAT_A * 65536.0);
+    p.thresholds[1] = (uint32_t)((RMAT_A + RMAT_B) * 65536.0);
+    p.thresholds[2] = (uint32_t)((RMAT_A + RMAT_B + RMAT_C) * 65536.0);
+
+    return build_csr_from_edges(num_nodes, num_edges, rmat_edge, &p);
+}
+
+/*
+ * Watts-Strogatz small worlds: a ring where every node links to its k/2
+ * successors, with each of those edges rewired to a uniform random target
+ * (other than its source) with probability beta. Rewired edges that
+ * duplicate an existing one are merged.
+ */
+typedef struct
+{
+    int num_nodes;
+    int half_degree;
+    double beta;
+    uint64_t key;
+} watts_strogatz_params;
+
+static void watts_strogatz_edge(const void *ctx, eidx_t e, int *u, int *v)
+{
+    const watts_strogatz_params *p = (const watts_strogatz_params *)ctx;
+    int source = (int)(e / p->half_degree);
+    int offset = (int)(e % p->half_degree) + 1;
+
+    *u = source;
+    *v = (int)(((int64_t)source + offset) % p->num_nodes);
+    if (rng_counter_double(p->key, 2 * (uint64_t)e) >= p->beta)
+        return;
+
+    for (uint64_t attempt = 0;; ++attempt)
+    {
+        uint64_t x = rng_counter(p->key, 2 * (uint64_t)e + 1 + (attempt << 48));
+        int target = (int)(((x >> 32) * (uint64_t)p->num_nodes) >> 32);
+        if (target != source)
+        {
+            *v = target;
+            return;
+        }
+    }
+}
+
+graph *generate_watts_strogatz(int num_nodes, int k, double beta)
+{
+    if (k < 2 || k % 2 != 0 || k >= num_nodes)
+        return NULL;
+
+    watts_strogatz_params p = {num_nodes, k / 2, beta, rng_stream_key(RNG_STREAM_GRAPH, 0)};
+    return build_csr_from_edges(num_nodes, (eidx_t)num_nodes * (k / 2), watts_strogatz_edge, &p);
+}
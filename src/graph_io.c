@@ -0,0 +1,777 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/data_structures.h"
+#include "../include/parallel.h"
+
+/*
+ * Parallel text edge-list I/O. The reader maps the file, splits the body
+ * into one chunk per thread at newline boundaries and parses each chunk
+ * into a private pair buffer. The CSR is then built with a counting sort
+ * partitioned by row: every thread routes the adjacency entries of its
+ * pairs to the thread owning the row, and each owner counts and scatters
+ * its rows without atomics, reading the routed entries in chunk order.
+ * Rows therefore list neighbours in file order, as the serial reader did.
+ * The writer formats node ranges into private buffers that are written
+ * out in order.
+ */
+
+typedef struct
+{
+    const char *data;
+    int num_nodes;
+    size_t *chunk_bounds;
+    int **pairs;
+    long *pair_counts;
+    long *keep_counts;
+    int *errors;
+    int **routed;
+    long *routed_counts;
+    long *row_totals;
+    graph *g;
+} text_load_task;
+
+/*
+ * Reads the next unsigned decimal integer in [p, end), skipping any
+ * separators. Returns NULL at end of input and sets *bad on a '-' sign
+ * or a value above limit.
+ */
+static inline const char *parse_bounded(const char *p, const char *end, uint64_t limit,
+                                        uint64_t *out, int *bad)
+{
+    while (p < end && (unsigned)(*p - '0') > 9)
+    {
+        if (*p == '-')
+            *bad = 1;
+        p++;
+    }
+    if (p == end)
+        return NULL;
+
+    uint64_t value = 0;
+    int digits = 0;
+    while (p < end && (unsigned)(*p - '0') <= 9)
+    {
+        value = value * 10 + (uint64_t)(*p - '0');
+        p++;
+        digits++;
+    }
+    if (digits > 19 || value > limit)
+        *bad = 1;
+    *out = value;
+    return p;
+}
+
+static inline const char *parse_uint(const char *p, const char *end, int *out, int *bad)
+{
+    uint64_t value = 0;
+    p = parse_bounded(p, end, INT32_MAX, &value, bad);
+    *out = (int)value;
+    return p;
+}
+
+/* Parses the '<nodes> <edges>' header; returns the start of the body. */
+static const char *parse_text_header(const char *data, const char *end, int *num_nodes,
+                                     eidx_t *num_unique_edges, int *bad)
+{
+    uint64_t edges = 0;
+    const char *p = parse_uint(data, end, num_nodes, bad);
+    if (p)
+        p = parse_bounded(p, end, (uint64_t)EIDX_MAX / 2, &edges, bad);
+    *num_unique_edges = (eidx_t)edges;
+    return p;
+}
+
+static void text_parse_worker(int thread_id, int num_threads, void *arg)
+{
+    text_load_task *task = (text_load_task *)arg;
+    const char *p = task->data + task->chunk_bounds[thread_id];
+    const char *end = task->data + task->chunk_bounds[thread_id + 1];
+    long capacity = (long)((end - p) / 4) + 16;
+    long count = 0;
+    int bad = 0;
+    int *pairs = (int *)malloc(capacity * 2 * sizeof(int));
+
+    (void)num_threads;
+
+    while (pairs && !bad)
+    {
+        int u, v;
+        p = parse_uint(p, end, &u, &bad);
+        if (!p)
+            break;
+        p = parse_uint(p, end, &v, &bad);
+        if (!p || u >= task->num_nodes || v >= task->num_nodes)
+        {
+            bad = 1;
+            break;
+        }
+
+        if (count == capacity)
+        {
+            capacity *= 2;
+            int *grown = (int *)realloc(pairs, capacity * 2 * sizeof(int));
+            if (!grown)
+            {
+                free(pairs);
+                pairs = NULL;
+                break;
+            }
+            pairs = grown;
+        }
+        pairs[2 * count] = u;
+        pairs[2 * count + 1] = v;
+        count++;
+    }
+
+    task->pairs[thread_id] = pairs;
+    task->pair_counts[thread_id] = count;
+    task->errors[thread_id] = bad || !pairs;
+}
+
+static int row_owner(int row, int num_nodes, int num_threads)
+{
+    return (int)((int64_t)row * num_threads / num_nodes);
+}
+
+static void row_range(int owner, int num_nodes, int num_threads, int *begin, int *end)
+{
+    *begin = (int)(((int64_t)owner * num_nodes + num_threads - 1) / num_threads);
+    *end = (int)(((int64_t)(owner + 1) * num_nodes + num_threads - 1) / num_threads);
+}
+
+/*
+ * Copies the adjacency entries (row, col) of this thread's pairs into one
+ * bucket per owning thread: routed[t * T + o] holds the entries of chunk t
+ * for rows of owner o, in file order.
+ */
+static void text_route_worker(int thread_id, int num_threads, void *arg)
+{
+    text_load_task *task = (text_load_task *)arg;
+    const int *pairs = task->pairs[thread_id];
+    long entries = 2 * task->keep_counts[thread_id];
+    long *counts = &task->routed_counts[(size_t)thread_id * num_threads];
+    int **routed = &task->routed[(size_t)thread_id * num_threads];
+    int ok = 1;
+
+    for (long i = 0; i < entries; ++i)
+        counts[row_owner(pairs[i], task->num_nodes, num_threads)]++;
+
+    for (int o = 0; o < num_threads; ++o)
+    {
+        routed[o] = (int *)malloc((counts[o] + 1) * 2 * sizeof(int));
+        ok = ok && routed[o];
+        counts[o] = 0;
+    }
+
+    for (long i = 0; ok && i < entries; ++i)
+    {
+        int row = pairs[i];
+        int col = pairs[i ^ 1];
+        int o = row_owner(row, task->num_nodes, num_threads);
+        routed[o][2 * counts[o]] = row;
+        routed[o][2 * counts[o] + 1] = col;
+        counts[o]++;
+    }
+
+    free(task->pairs[thread_id]);
+    task->pairs[thread_id] = NULL;
+    task->errors[thread_id] = !ok;
+}
+
+static void text_build_worker(int thread_id, int num_threads, void *arg)
+{
+    text_load_task *task = (text_load_task *)arg;
+    graph *g = task->g;
+    int begin, end;
+
+    row_range(thread_id, task->num_nodes, num_threads, &begin, &end);
+
+    for (int t = 0; t < num_threads; ++t)
+    {
+        const int *entries = task->routed[(size_t)t * num_threads + thread_id];
+        long count = task->routed_counts[(size_t)t * num_threads + thread_id];
+        for (long i = 0; i < count; ++i)
+            g->row_ptr[entries[2 * i] + 1]++;
+    }
+
+    long total = 0;
+    for (int u = begin; u < end; ++u)
+        total += g->row_ptr[u + 1];
+    task->row_totals[thread_id] = total;
+    parallel_barrier();
+
+    long offset = 0;
+    for (int t = 0; t < thread_id; ++t)
+        offset += task->row_totals[t];
+
+    for (int u = begin; u < end; ++u)
+    {
+        long degree = g->row_ptr[u + 1];
+        g->row_ptr[u + 1] = (eidx_t)offset;
+        offset += degree;
+    }
+    if (begin == 0)
+        g->row_ptr[0] = 0;
+
+    /* row_ptr[u + 1] serves as the cursor of row u; it ends at row u's end. */
+    for (int t = 0; t < num_threads; ++t)
+    {
+        const int *entries = task->routed[(size_t)t * num_threads + thread_id];
+        long count = task->routed_counts[(size_t)t * num_threads + thread_id];
+        for (long i = 0; i < count; ++i)
+        {
+            int row = entries[2 * i];
+            g->col_ind[g->row_ptr[row + 1]++] = entries[2 * i + 1];
+        }
+    }
+}
+
+graph *load_graph_from_text(const char *filename)
+{
+    if (!filename)
+        return NULL;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    const char *data = (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        perror("Error mapping graph file");
+        return NULL;
+    }
+    madvise((void *)data, size, MADV_SEQUENTIAL);
+
+    int num_nodes = 0, bad = 0;
+    eidx_t num_unique_edges = 0;
+    const char *p = parse_text_header(data, data + size, &num_nodes, &num_unique_edges, &bad);
+    if (!p || bad || num_nodes <= 0)
+    {
+        munmap((void *)data, size);
+        return NULL;
+    }
+    while (p < data + size && *p != '\n')
+        p++;
+
+    int num_threads = parallel_num_threads();
+    size_t num_buckets = (size_t)num_threads * num_threads;
+    text_load_task task;
+    memset(&task, 0, sizeof(task));
+    task.data = data;
+    task.num_nodes = num_nodes;
+    task.chunk_bounds = (size_t *)malloc((num_threads + 1) * sizeof(size_t));
+    task.pairs = (int **)calloc(num_threads, sizeof(int *));
+    task.pair_counts = (long *)calloc(num_threads, sizeof(long));
+    task.keep_counts = (long *)calloc(num_threads, sizeof(long));
+    task.errors = (int *)calloc(num_threads, sizeof(int));
+    task.routed = (int **)calloc(num_buckets, sizeof(int *));
+    task.routed_counts = (long *)calloc(num_buckets, sizeof(long));
+    task.row_totals = (long *)calloc(num_threads, sizeof(long));
+    graph *g = NULL;
+    const char *error = NULL;
+
+    if (!task.chunk_bounds || !task.pairs || !task.pair_counts || !task.keep_counts ||
+        !task.errors || !task.routed || !task.routed_counts || !task.row_totals)
+        error = "out of memory";
+
+    if (!error)
+    {
+        size_t body = (size_t)(p - data);
+        for (int t = 0; t <= num_threads; ++t)
+        {
+            size_t b = body + (size - body) * (size_t)t / (size_t)num_threads;
+            while (t > 0 && t < num_threads && b < size && data[b - 1] != '\n')
+                b++;
+            if (t > 0 && b < task.chunk_bounds[t - 1])
+                b = task.chunk_bounds[t - 1];
+            task.chunk_bounds[t] = b;
+        }
+        task.chunk_bounds[num_threads] = size;
+
+        parallel_run(text_parse_worker, &task);
+
+        long remaining = num_unique_edges;
+        for (int t = 0; t < num_threads; ++t)
+        {
+            if (task.errors[t])
+                error = "malformed edge or node id out of range";
+            task.keep_counts[t] = task.pair_counts[t] < remaining ? task.pair_counts[t] : remaining;
+            remaining -= task.keep_counts[t];
+        }
+        if (!error && remaining > 0)
+            error = "fewer edges than declared in the header";
+    }
+
+    if (!error)
+    {
+        parallel_run(text_route_worker, &task);
+        for (int t = 0; t < num_threads; ++t)
+        {
+            if (task.errors[t])
+                error = "out of memory";
+        }
+    }
+
+    if (!error)
+    {
+        g = create_graph(num_nodes, num_unique_edges * 2);
+        if (!g)
+            error = "out of memory";
+    }
+
+    if (!error)
+    {
+        task.g = g;
+        parallel_run(text_build_worker, &task);
+    }
+
+    for (int t = 0; task.pairs && t < num_threads; ++t)
+        free(task.pairs[t]);
+    for (size_t b = 0; task.routed && b < num_buckets; ++b)
+        free(task.routed[b]);
+    free(task.pairs);
+    free(task.routed);
+    free(task.routed_counts);
+    free(task.row_totals);
+    free(task.chunk_bounds);
+    free(task.pair_counts);
+    free(task.keep_counts);
+    free(task.errors);
+    munmap((void *)data, size);
+
+    if (error)
+    {
+        fprintf(stderr, "Error: Failed to parse %s (%s)\n", filename, error);
+        free_graph(g);
+        return NULL;
+    }
+
+    printf("[OK] Graph loaded from %s (%d nodes, %" PRIeidx " edges)\n", filename, num_nodes, g->num_edges);
+    return g;
+}
+
+typedef struct
+{
+    graph *g;
+    const int *bounds;
+    char **buffers;
+    size_t *lengths;
+} text_save_task;
+
+static char *format_uint(char *out, int value)
+{
+    char tmp[12];
+    int len = 0;
+
+    do
+    {
+        tmp[len++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    while (len > 0)
+        *out++ = tmp[--len];
+    return out;
+}
+
+static void text_format_worker(int thread_id, int num_threads, void *arg)
+{
+    text_save_task *task = (text_save_task *)arg;
+    graph *g = task->g;
+    int begin = task->bounds[thread_id];
+    int end = task->bounds[thread_id + 1];
+
+    (void)num_threads;
+
+    /* A self-loop is stored as two entries of its row, as the loaders
+     * build it; every second one is written out. */
+    long lines = 0;
+    for (int u = begin; u < end; ++u)
+    {
+        int loops = 0;
+        for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
+        {
+            lines += u < g->col_ind[j];
+            loops += u == g->col_ind[j];
+        }
+        lines += loops / 2;
+    }
+
+    char *buffer = (char *)malloc((size_t)lines * 24 + 1);
+    char *out = buffer;
+    for (int u = begin; buffer && u < end; ++u)
+    {
+        int loops = 0;
+        for (eidx_t j = g->row_ptr[u]; j < g->row_ptr[u + 1]; ++j)
+        {
+            int v = g->col_ind[j];
+            if (u < v || (u == v && (loops++ & 1)))
+            {
+                out = format_uint(out, u);
+                *out++ = ' ';
+                out = format_uint(out, v);
+                *out++ = '\n';
+            }
+        }
+    }
+
+    task->buffers[thread_id] = buffer;
+    task->lengths[thread_id] = buffer ? (size_t)(out - buffer) : 0;
+}
+
+int save_graph_to_text(graph *g, const char *filename)
+{
+    if (!g || !filename)
+        return 0;
+
+    FILE *f = fopen(filename, "w");
+    if (!f)
+    {
+        perror("Error opening file for writing");
+        return 0;
+    }
+
+    int num_threads = parallel_num_threads();
+    int *bounds = (int *)malloc((num_threads + 1) * sizeof(int));
+    char **buffers = (char **)calloc(num_threads, sizeof(char *));
+    size_t *lengths = (size_t *)calloc(num_threads, sizeof(size_t));
+    int ok = bounds && buffers && lengths;
+
+    if (ok)
+    {
+        parallel_partition_by_edges(g, num_threads, bounds);
+        text_save_task task = {g, bounds, buffers, lengths};
+        parallel_run(text_format_worker, &task);
+
+        eidx_t unique_edges = g->num_edges / 2;
+        ok = fprintf(f, "%d %" PRIeidx "\n", g->num_nodes, unique_edges) > 0;
+        for (int t = 0; ok && t < num_threads; ++t)
+        {
+            ok = buffers[t] != NULL && fwrite(buffers[t], 1, lengths[t], f) == lengths[t];
+        }
+    }
+
+    for (int t = 0; buffers && t < num_threads; ++t)
+        free(buffers[t]);
+    free(buffers);
+    free(lengths);
+    free(bounds);
+
+    if (fclose(f) != 0 || !ok)
+    {
+        fprintf(stderr, "Error: Failed to write graph to %s\n", filename);
+        return 0;
+    }
+    printf("[OK] Graph saved to %s (text format)\n", filename);
+    return 1;
+}
+
+/*
+ * Out-of-core conversion of a text edge list into the binary CSR format.
+ * The output file is written through a shared mapping. Pass one counts
+ * degrees into its row_ptr, which splits the rows into windows of at most
+ * window_bytes of adjacency entries. Pass two spills every entry (row,
+ * neighbour) into an unlinked bucket file per window; each window of
+ * col_ind is then filled from its own bucket, flushed and dropped. The
+ * input is read twice and the spill written and read once, so I/O stays
+ * linear, and resident memory stays near row_ptr plus one window however
+ * large the edge list is. At most STREAM_MAX_BUCKETS buckets are open at
+ * a time; past that many windows the spill pass repeats per group. A
+ * graph that fits in one window is filled straight from the input.
+ * Neighbours keep file order.
+ */
+#define STREAM_MAX_BUCKETS 256
+#define BUCKET_BATCH 4096
+
+typedef struct
+{
+    const char *p;
+    const char *end;
+    long remaining;
+} edge_stream;
+
+static int edge_stream_next(edge_stream *s, int num_nodes, int *u, int *v, int *bad)
+{
+    if (s->remaining == 0)
+        return 0;
+    s->p = parse_uint(s->p, s->end, u, bad);
+    if (s->p)
+        s->p = parse_uint(s->p, s->end, v, bad);
+    if (!s->p || *u >= num_nodes || *v >= num_nodes)
+    {
+        *bad = 1;
+        return 0;
+    }
+    s->remaining--;
+    return 1;
+}
+
+/* Splits the rows into windows; fills starts[0..count] when given. */
+static int stream_windows(const eidx_t *row_ptr, int num_nodes, size_t window_entries, int *starts)
+{
+    int count = 0;
+    for (int begin = 0; begin < num_nodes; count++)
+    {
+        int end = begin + 1;
+        while (end < num_nodes && (size_t)(row_ptr[end + 1] - row_ptr[begin]) <= window_entries)
+            end++;
+        if (starts)
+            starts[count] = begin;
+        begin = end;
+    }
+    if (starts)
+        starts[count] = num_nodes;
+    return count;
+}
+
+static int window_of(const int *starts, int windows, int row)
+{
+    int lo = 0, hi = windows - 1;
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (starts[mid] <= row)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return lo;
+}
+
+static FILE *open_bucket(const char *temp, int window)
+{
+    size_t len = strlen(temp) + 16;
+    char *name = (char *)malloc(len);
+    FILE *f = NULL;
+    if (name)
+    {
+        snprintf(name, len, "%s.%d", temp, window);
+        f = fopen(name, "w+b");
+        if (f)
+            unlink(name);
+        free(name);
+    }
+    return f;
+}
+
+static void append_entry(FILE *bucket, int row, int col, int *bad)
+{
+    int entry[2] = {row, col};
+    if (fwrite(entry, sizeof(int), 2, bucket) != 2)
+        *bad = 1;
+}
+
+/* Scatters the spilled entries of rows [begin, end) into col_ind. */
+static int fill_window_from_bucket(FILE *bucket, int begin, int end, const eidx_t *row_ptr, int *col_ind)
+{
+    eidx_t *cursor = (eidx_t *)malloc((size_t)(end - begin) * sizeof(eidx_t));
+    int *entries = (int *)malloc(2 * BUCKET_BATCH * sizeof(int));
+    int ok = cursor && entries && fflush(bucket) == 0 && fseek(bucket, 0, SEEK_SET) == 0;
+    size_t got;
+
+    if (ok)
+        memcpy(cursor, &row_ptr[begin], (size_t)(end - begin) * sizeof(eidx_t));
+    while (ok && (got = fread(entries, 2 * sizeof(int), BUCKET_BATCH, bucket)) > 0)
+    {
+        for (size_t i = 0; i < got; ++i)
+            col_ind[cursor[entries[2 * i] - begin]++] = entries[2 * i + 1];
+    }
+    ok = ok && !ferror(bucket);
+
+    free(cursor);
+    free(entries);
+    return ok;
+}
+
+static void release_window(const eidx_t *row_ptr, int *col_ind, int begin, int end)
+{
+    char *first = (char *)&col_ind[row_ptr[begin]];
+    char *last = (char *)&col_ind[row_ptr[end]];
+    char *page = (char *)((uintptr_t)first & ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1));
+    msync(page, (size_t)(last - page), MS_SYNC);
+    madvise(page, (size_t)(last - page), MADV_DONTNEED);
+}
+
+int convert_text_to_binary(const char *text_file, const char *binary_file, size_t window_bytes)
+{
+    int in_fd = open(text_file, O_RDONLY);
+    if (in_fd < 0)
+    {
+        perror("Error opening edge list");
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(in_fd, &st) != 0 || st.st_size == 0)
+    {
+        close(in_fd);
+        return 0;
+    }
+
+    size_t in_size = (size_t)st.st_size;
+    const char *in = (const char *)mmap(NULL, in_size, PROT_READ, MAP_PRIVATE, in_fd, 0);
+    close(in_fd);
+    if (in == MAP_FAILED)
+    {
+        perror("Error mapping edge list");
+        return 0;
+    }
+
+    int num_nodes = 0, bad = 0;
+    eidx_t num_unique_edges = 0;
+    const char *body = parse_text_header(in, in + in_size, &num_nodes, &num_unique_edges, &bad);
+    if (!body || bad || num_nodes <= 0)
+    {
+        fprintf(stderr, "Error: %s has no valid '<nodes> <edges>' header\n", text_file);
+        munmap((void *)in, in_size);
+        return 0;
+    }
+
+    graph_file_header h;
+    graph_file_header_init(&h, (uint64_t)num_nodes, (uint64_t)num_unique_edges * 2);
+    size_t out_size = (size_t)(h.col_ind_offset + h.num_edges * h.node_bytes);
+
+    /* Built under a temporary name and renamed at the end, so binary_file
+     * may even be text_file: the input is never truncated or removed. */
+    char *temp = graph_temp_path(binary_file);
+    int out_fd = temp ? open(temp, O_RDWR | O_CREAT | O_TRUNC, 0644) : -1;
+    if (out_fd < 0 || ftruncate(out_fd, (off_t)out_size) != 0)
+    {
+        perror("Error creating binary graph file");
+        if (out_fd >= 0)
+        {
+            close(out_fd);
+            unlink(temp);
+        }
+        free(temp);
+        munmap((void *)in, in_size);
+        return 0;
+    }
+
+    char *out = (char *)mmap(NULL, out_size, PROT_READ | PROT_WRITE, MAP_SHARED, out_fd, 0);
+    close(out_fd);
+    if (out == MAP_FAILED)
+    {
+        perror("Error mapping binary graph file");
+        unlink(temp);
+        free(temp);
+        munmap((void *)in, in_size);
+        return 0;
+    }
+
+    eidx_t *row_ptr = (eidx_t *)(out + h.row_ptr_offset);
+    int *col_ind = (int *)(out + h.col_ind_offset);
+    edge_stream s;
+    int u, v;
+
+    madvise((void *)in, in_size, MADV_SEQUENTIAL);
+
+    s = (edge_stream){body, in + in_size, num_unique_edges};
+    while (edge_stream_next(&s, num_nodes, &u, &v, &bad))
+    {
+        row_ptr[u + 1]++;
+        row_ptr[v + 1]++;
+    }
+    if (!bad && s.remaining > 0)
+        bad = 1;
+
+    for (int i = 0; !bad && i < num_nodes; ++i)
+        row_ptr[i + 1] += row_ptr[i];
+
+    size_t window_entries = window_bytes / sizeof(int) > 0 ? window_bytes / sizeof(int) : 1;
+    int windows = bad ? 0 : stream_windows(row_ptr, num_nodes, window_entries, NULL);
+
+    if (windows == 1)
+    {
+        eidx_t *cursor = (eidx_t *)malloc((size_t)num_nodes * sizeof(eidx_t));
+        bad = !cursor;
+        if (cursor)
+            memcpy(cursor, row_ptr, (size_t)num_nodes * sizeof(eidx_t));
+
+        s = (edge_stream){body, in + in_size, num_unique_edges};
+        while (!bad && edge_stream_next(&s, num_nodes, &u, &v, &bad))
+        {
+            col_ind[cursor[u]++] = v;
+            col_ind[cursor[v]++] = u;
+        }
+        free(cursor);
+    }
+    else if (windows > 1)
+    {
+        int *starts = (int *)malloc(((size_t)windows + 1) * sizeof(int));
+        FILE *buckets[STREAM_MAX_BUCKETS] = {NULL};
+        bad = !starts;
+        if (!bad)
+            stream_windows(row_ptr, num_nodes, window_entries, starts);
+
+        for (int first = 0; !bad && first < windows; first += STREAM_MAX_BUCKETS)
+        {
+            int last = windows - first > STREAM_MAX_BUCKETS ? first + STREAM_MAX_BUCKETS : windows;
+            for (int w = first; !bad && w < last; ++w)
+                bad = (buckets[w - first] = open_bucket(temp, w)) == NULL;
+
+            s = (edge_stream){body, in + in_size, num_unique_edges};
+            while (!bad && edge_stream_next(&s, num_nodes, &u, &v, &bad))
+            {
+                if (u >= starts[first] && u < starts[last])
+                    append_entry(buckets[window_of(starts, windows, u) - first], u, v, &bad);
+                if (v >= starts[first] && v < starts[last])
+                    append_entry(buckets[window_of(starts, windows, v) - first], v, u, &bad);
+            }
+            madvise((void *)in, in_size, MADV_DONTNEED);
+
+            for (int w = first; w < last; ++w)
+            {
+                if (!bad)
+                {
+                    bad = !fill_window_from_bucket(buckets[w - first], starts[w], starts[w + 1],
+                                                   row_ptr, col_ind);
+                    release_window(row_ptr, col_ind, starts[w], starts[w + 1]);
+                }
+                if (buckets[w - first])
+                    fclose(buckets[w - first]);
+                buckets[w - first] = NULL;
+            }
+        }
+        free(starts);
+    }
+
+    if (!bad)
+    {
+        memcpy(out, &h, sizeof(h));
+        bad = msync(out, out_size, MS_SYNC) != 0;
+    }
+    munmap(out, out_size);
+    munmap((void *)in, in_size);
+
+    if (!bad)
+        bad = rename(temp, binary_file) != 0;
+    if (bad)
+        unlink(temp);
+    free(temp);
+    if (bad)
+    {
+        fprintf(stderr, "Error: Failed to convert %s (malformed edge list or I/O error)\n", text_file);
+        return 0;
+    }
+
+    printf("[OK] Streamed %s into %s (%d nodes, %" PRIeidx " edges, %d window%s)\n", text_file, binary_file,
+           num_nodes, num_unique_edges * 2, windows, windows == 1 ? "" : "s");
+    return 1;
+}
@@ -7,6 +7,7 @@
 #include <time.h>
 #include "../include/min_cost_flow.h"
 #include "../include/logging.h"
+#include "../include/rng.h"
 
 #define INF_COST 1e9
 #define INF_CAP  1000000
@@ -390,9 +391,12 @@ void run_part3_matching_market(graph *g, unsigned char *security_set, int limite
     }
 
 
+    rng_state rng;
+    rng_init(&rng, RNG_STREAM_MARKET, (uint64_t)limited_capacity);
+
     int *budgets = malloc(num_buyers * sizeof(int));
     for(int i=0; i<num_buyers; i++) {
-        budgets[i] = (rand() % 100) + 1;
+        budgets[i] = (int)rng_next_bounded(&rng, 100) + 1;
     }
 
 
@@ -400,10 +404,10 @@ void run_part3_matching_market(graph *g, unsigned char *security_set, int limite
     vendor_t *vendors = malloc(num_vendors * sizeof(vendor_t));
 
     for(int i=0; i<num_vendors; i++) {
-        vendors[i].price = (rand() % 100) + 1;
-        vendors[i].quality = (rand() % 10) + 1;
+        vendors[i].price = (int)rng_next_bounded(&rng, 100) + 1;
+        vendors[i].quality = (int)rng_next_bounded(&rng, 10) + 1;
         if (limited_capacity) {
-            vendors[i].capacity = (rand() % 5) + 1;
+            vendors[i].capacity = (int)rng_next_bounded(&rng, 5) + 1;
         } else {
             vendors[i].capacity = num_buyers;
         }
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../include/parallel.h"
+
+static pthread_t *workers = NULL;
+static int pool_size = 1;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t start_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+
+static parallel_task current_task = NULL;
+static void *current_arg = NULL;
+static unsigned long generation = 0;
+static int pending = 0;
+static int shutting_down = 0;
+
+static pthread_mutex_t barrier_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t barrier_cond = PTHREAD_COND_INITIALIZER;
+static int barrier_waiting = 0;
+static unsigned long barrier_generation = 0;
+
+static void *worker_main(void *p)
+{
+    int thread_id = (int)(intptr_t)p;
+    unsigned long seen = 0;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&pool_lock);
+        while (generation == seen && !shutting_down)
+            pthread_cond_wait(&start_cond, &pool_lock);
+
+        if (shutting_down)
+        {
+            pthread_mutex_unlock(&pool_lock);
+            break;
+        }
+
+        seen = generation;
+        parallel_task task = current_task;
+        void *arg = current_arg;
+        pthread_mutex_unlock(&pool_lock);
+
+        task(thread_id, pool_size, arg);
+
+        pthread_mutex_lock(&pool_lock);
+        if (--pending == 0)
+            pthread_cond_signal(&done_cond);
+        pthread_mutex_unlock(&pool_lock);
+    }
+
+    return NULL;
+}
+
+void parallel_init(int num_threads)
+{
+    parallel_shutdown();
+
+    if (num_threads < 1)
+        num_threads = 1;
+
+    pool_size = num_threads;
+    shutting_down = 0;
+    if (pool_size == 1)
+        return;
+
+    workers = (pthread_t *)malloc((pool_size - 1) * sizeof(pthread_t));
+    if (!workers)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in parallel_init, running single-threaded\n");
+        pool_size = 1;
+        return;
+    }
+
+    for (int i = 1; i < pool_size; ++i)
+    {
+        if (pthread_create(&workers[i - 1], NULL, worker_main, (void *)(intptr_t)i) != 0)
+        {
+            fprintf(stderr, "Error: Failed to start worker thread %d\n", i);
+            exit(1);
+        }
+    }
+}
+
+void parallel_shutdown(void)
+{
+    if (!workers)
+        return;
+
+    pthread_mutex_lock(&pool_lock);
+    shutting_down = 1;
+    pthread_cond_broadcast(&start_cond);
+    pthread_mutex_unlock(&pool_lock);
+
+    for (int i = 1; i < pool_size; ++i)
+        pthread_join(workers[i - 1], NULL);
+
+    free(workers);
+    workers = NULL;
+    pool_size = 1;
+}
+
+int parallel_num_threads(void)
+{
+    return pool_size;
+}
+
+void parallel_run(parallel_task task, void *arg)
+{
+    if (pool_size == 1)
+    {
+        task(0, 1, arg);
+        return;
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    current_task = task;
+    current_arg = arg;
+    pending = pool_size - 1;
+    generation++;
+    pthread_cond_broadcast(&start_cond);
+    pthread_mutex_unlock(&pool_lock);
+
+    task(0, pool_size, arg);
+
+    pthread_mutex_lock(&pool_lock);
+    while (pending > 0)
+        pthread_cond_wait(&done_cond, &pool_lock);
+    pthread_mutex_unlock(&pool_lock);
+}
+
+void parallel_barrier(void)
+{
+    if (pool_size == 1)
+        return;
+
+    pthread_mutex_lock(&barrier_lock);
+    unsigned long gen = barrier_generation;
+
+    if (++barrier_waiting == pool_size)
+    {
+        barrier_waiting = 0;
+        barrier_generation++;
+        pthread_cond_broadcast(&barrier_cond);
+    }
+    else
+    {
+        while (gen == barrier_generation)
+            pthread_cond_wait(&barrier_cond, &barrier_lock);
+    }
+    pthread_mutex_unlock(&barrier_lock);
+}
+
+void parallel_block(long n, int thread_id, int num_threads, long *begin, long *end)
+{
+    long chunk = n / num_threads;
+    long rest = n % num_threads;
+
+    *begin = thread_id * chunk + (thread_id < rest ? thread_id : rest);
+    *end = *begin + chunk + (thread_id < rest ? 1 : 0);
+}
+
+/*
+ * Splits the node range into num_parts contiguous blocks of roughly equal
+ * work, counting one unit per node plus one per adjacency entry, so that
+ * hub-heavy ranges get fewer nodes. bounds must hold num_parts + 1 entries.
+ */
+void parallel_partition_by_edges(graph *g, int num_parts, int *bounds)
+{
+    int n = g->num_nodes;
+    long total = (long)n + g->num_edges;
+
+    bounds[0] = 0;
+    for (int p = 1; p < num_parts; ++p)
+    {
+        long target = total * p / num_parts;
+        int lo = bounds[p - 1];
+        int hi = n;
+
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if ((long)mid + g->row_ptr[mid] < target)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        bounds[p] = lo;
+    }
+    bounds[num_parts] = n;
+}
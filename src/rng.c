@@ -0,0 +1,60 @@
+#include <stdint.h>
+#include "../include/rng.h"
+
+static uint64_t global_seed = 0;
+
+void rng_set_seed(uint64_t seed)
+{
+    global_seed = seed;
+}
+
+uint64_t rng_get_seed(void)
+{
+    return global_seed;
+}
+
+uint64_t rng_stream_key(rng_stream_id stream, uint64_t index)
+{
+    uint64_t k = rng_mix64(global_seed + 0x9E3779B97F4A7C15ULL);
+    k = rng_mix64(k ^ ((uint64_t)stream * 0xD1B54A32D192ED03ULL));
+    return rng_mix64(k ^ (index * 0xAEF17502108EF2D9ULL + 1));
+}
+
+void rng_init(rng_state *st, rng_stream_id stream, uint64_t index)
+{
+    uint64_t x = rng_stream_key(stream, index);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        x += 0x9E3779B97F4A7C15ULL;
+        st->s[i] = rng_mix64(x);
+    }
+}
+
+void rng_jump(rng_state *st)
+{
+    static const uint64_t jump[4] = {
+        0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+        0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int b = 0; b < 64; ++b)
+        {
+            if (jump[i] & ((uint64_t)1 << b))
+            {
+                s0 ^= st->s[0];
+                s1 ^= st->s[1];
+                s2 ^= st->s[2];
+                s3 ^= st->s[3];
+            }
+            rng_next(st);
+        }
+    }
+
+    st->s[0] = s0;
+    st->s[1] = s1;
+    st->s[2] = s2;
+    st->s[3] = s3;
+}
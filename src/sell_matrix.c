@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "../include/sell_matrix.h"
+#include "../include/parallel.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * Building the layout takes two parallel passes: the sigma windows are
+ * sorted by decreasing degree (ties by row id, so the layout does not
+ * depend on the thread count), then, after a serial prefix sum over the
+ * chunk widths, every chunk is filled column by column.
+ */
+
+typedef struct
+{
+    graph *g;
+    sell_matrix *s;
+    uint64_t *keys;
+} sell_task;
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void sell_sort_worker(int thread_id, int num_threads, void *arg)
+{
+    sell_task *task = (sell_task *)arg;
+    graph *g = task->g;
+    sell_matrix *s = task->s;
+    long num_windows = ((long)s->num_rows + s->sigma - 1) / s->sigma;
+    long begin, end;
+
+    parallel_block(num_windows, thread_id, num_threads, &begin, &end);
+    for (long w = begin; w < end; ++w)
+    {
+        int first = (int)(w * s->sigma);
+        int last = first + s->sigma < s->num_rows ? first + s->sigma : s->num_rows;
+        uint64_t *keys = &task->keys[first];
+
+        for (int row = first; row < last; ++row)
+        {
+            uint64_t degree = (uint64_t)(g->row_ptr[row + 1] - g->row_ptr[row]);
+            keys[row - first] = ((UINT32_MAX - degree) << 32) | (uint32_t)row;
+        }
+        qsort(keys, (size_t)(last - first), sizeof(uint64_t), compare_u64);
+        for (int row = first; row < last; ++row)
+            s->perm[row] = (int)(uint32_t)keys[row - first];
+    }
+}
+
+static void sell_fill_worker(int thread_id, int num_threads, void *arg)
+{
+    sell_task *task = (sell_task *)arg;
+    graph *g = task->g;
+    sell_matrix *s = task->s;
+    int c = s->chunk_size;
+    long begin, end;
+
+    parallel_block(s->num_chunks, thread_id, num_threads, &begin, &end);
+    for (long chunk = begin; chunk < end; ++chunk)
+    {
+        int *cols = &s->col_ind[s->chunk_ptr[chunk]];
+        int width = (int)((s->chunk_ptr[chunk + 1] - s->chunk_ptr[chunk]) / c);
+
+        for (int lane = 0; lane < c; ++lane)
+        {
+            int row = s->perm[chunk * c + lane];
+            int degree = row < 0 ? 0 : (int)(g->row_ptr[row + 1] - g->row_ptr[row]);
+            const int *adj = row < 0 ? NULL : &g->col_ind[g->row_ptr[row]];
+
+            for (int j = 0; j < width; ++j)
+                cols[(size_t)j * c + lane] = j < degree ? adj[j] : s->num_rows;
+        }
+    }
+}
+
+sell_matrix *build_sell_matrix(graph *g, int chunk_size, int sigma)
+{
+    int n = g->num_nodes;
+    int c = chunk_size;
+    sell_matrix *s = (sell_matrix *)calloc(1, sizeof(sell_matrix));
+    if (!s)
+        return NULL;
+
+    s->chunk_size = c;
+    s->sigma = sigma;
+    s->num_rows = n;
+    s->num_chunks = (int)(((long)n + c - 1) / c);
+    s->perm = (int *)malloc((size_t)s->num_chunks * c * sizeof(int));
+    s->chunk_ptr = (eidx_t *)malloc(((size_t)s->num_chunks + 1) * sizeof(eidx_t));
+    uint64_t *keys = (uint64_t *)malloc((size_t)n * sizeof(uint64_t));
+
+    if (!s->perm || !s->chunk_ptr || !keys)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in build_sell_matrix\n");
+        free(keys);
+        free_sell_matrix(s);
+        return NULL;
+    }
+
+    for (long slot = 0; slot < (long)s->num_chunks * c; ++slot)
+        s->perm[slot] = slot < n ? (int)slot : -1;
+
+    sell_task task = {g, s, keys};
+    if (sigma > 1)
+        parallel_run(sell_sort_worker, &task);
+    free(keys);
+
+    s->chunk_ptr[0] = 0;
+    for (int chunk = 0; chunk < s->num_chunks; ++chunk)
+    {
+        eidx_t width = 0;
+        for (int lane = 0; lane < c; ++lane)
+        {
+            int row = s->perm[(long)chunk * c + lane];
+            if (row >= 0 && g->row_ptr[row + 1] - g->row_ptr[row] > width)
+                width = g->row_ptr[row + 1] - g->row_ptr[row];
+        }
+        if (width > (EIDX_MAX - s->chunk_ptr[chunk]) / c)
+        {
+            fprintf(stderr, "Error: Padded SELL layout exceeds %d-bit offsets (build with WIDE=1)\n",
+                    (int)(8 * sizeof(eidx_t)));
+            free_sell_matrix(s);
+            return NULL;
+        }
+        s->chunk_ptr[chunk + 1] = s->chunk_ptr[chunk] + width * c;
+    }
+
+    s->col_ind = (int *)malloc((size_t)s->chunk_ptr[s->num_chunks] * sizeof(int));
+    if (!s->col_ind && s->chunk_ptr[s->num_chunks] > 0)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in build_sell_matrix\n");
+        free_sell_matrix(s);
+        return NULL;
+    }
+    parallel_run(sell_fill_worker, &task);
+
+    return s;
+}
+
+void free_sell_matrix(sell_matrix *s)
+{
+    if (!s)
+        return;
+    free(s->perm);
+    free(s->chunk_ptr);
+    free(s->col_ind);
+    free(s);
+}
+
+/* Chunks [begin, end) of part out of num_parts, balanced by slots plus
+ * stored entries. */
+void sell_partition(const sell_matrix *s, int part, int num_parts, int *begin, int *end)
+{
+    int bounds[2];
+    long total = (long)s->num_chunks * s->chunk_size + (long)s->chunk_ptr[s->num_chunks];
+
+    for (int b = 0; b < 2; ++b)
+    {
+        long target = total * (part + b) / num_parts;
+        int lo = 0, hi = s->num_chunks;
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if ((long)mid * s->chunk_size + (long)s->chunk_ptr[mid] < target)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        bounds[b] = lo;
+    }
+    *begin = bounds[0];
+    *end = (part == num_parts - 1) ? s->num_chunks : bounds[1];
+}
+
+/*
+ * On AVX2 four lanes of a chunk advance together with one gather of their
+ * beliefs per column; the arithmetic is the scalar expression lane by
+ * lane, so the sums equal the CSR loop. Remaining lanes, and other
+ * targets, use the scalar loop with the lanes innermost, which the
+ * compiler can vectorise as well.
+ */
+void sell_unsecured_penalty(const sell_matrix *s, int chunk, const double *believes, double *out)
+{
+    int c = s->chunk_size;
+    const int *cols = &s->col_ind[s->chunk_ptr[chunk]];
+    int width = (int)((s->chunk_ptr[chunk + 1] - s->chunk_ptr[chunk]) / c);
+    int lane = 0;
+
+#if defined(__AVX2__)
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d penalty = _mm256_set1_pd(PENALTY_UNSECURED);
+
+    for (; lane + 4 <= c; lane += 4)
+    {
+        __m256d acc = _mm256_setzero_pd();
+        for (int j = 0; j < width; ++j)
+        {
+            __m128i ids = _mm_loadu_si128((const __m128i *)(cols + (size_t)j * c + lane));
+            __m256d belief = _mm256_i32gather_pd(believes, ids, 8);
+            acc = _mm256_sub_pd(acc, _mm256_mul_pd(penalty, _mm256_sub_pd(one, belief)));
+        }
+        _mm256_storeu_pd(out + lane, acc);
+    }
+#endif
+
+    for (int l = lane; l < c; ++l)
+        out[l] = 0.0;
+    for (int j = 0; j < width; ++j)
+    {
+        const int *col = cols + (size_t)j * c;
+        for (int l = lane; l < c; ++l)
+            out[l] -= PENALTY_UNSECURED * (1.0 - believes[col[l]]);
+    }
+}
@@ -4,31 +4,35 @@
 #include <math.h>
 #include <string.h>
 #include "../include/strategic_game.h"
+#include "../include/graph_reorder.h"
+#include "../include/bitset.h"
 #include "../include/logging.h"
-
-static double get_random_double()
-{
-    return (double)rand() / (double)RAND_MAX;
-}
+#include "../include/parallel.h"
+#include "../include/rng.h"
 
 double calculate_utility(game_system *game, int player_id, int strategy)
 {
     if (strategy == 1)
         return -COST_SECURITY;
 
-    double curr_payoff = 0.0;
-    int start = game->g->row_ptr[player_id];
-    int end = game->g->row_ptr[player_id + 1];
+    return -PENALTY_UNSECURED * game->unsecured_neighbors[player_id];
+}
 
-    for (int i = start; i < end; ++i)
-    {
-        int neighbor_id = game->g->col_ind[i];
-        if (game->strategies[neighbor_id] == 0)
-        {
-            curr_payoff -= PENALTY_UNSECURED;
-        }
-    }
-    return curr_payoff;
+static int best_response(game_system *game, int player_id, double *utility)
+{
+    int curr_strategy = bitset_test(game->strategy_bits, player_id);
+    double u_out = calculate_utility(game, player_id, 0);
+    double u_in = calculate_utility(game, player_id, 1);
+
+    int best_strategy = curr_strategy;
+
+    if (u_in > u_out)
+        best_strategy = 1;
+    else if (u_out > u_in)
+        best_strategy = 0;
+
+    *utility = (best_strategy == 1) ? u_in : u_out;
+    return best_strategy;
 }
 
 int run_best_response_iteration(game_system *game)
@@ -37,97 +41,204 @@ int run_best_response_iteration(game_system *game)
 
     for (int i = 0; i < game->num_players; ++i)
     {
-        int curr_strategy = game->strategies[i];
-        double u_out = calculate_utility(game, i, 0);
-        double u_in = calculate_utility(game, i, 1);
-
-        int best_strategy = curr_strategy;
-
-        if (u_in > u_out)
-            best_strategy = 1;
-        else if (u_out > u_in)
-            best_strategy = 0;
+        int curr_strategy = bitset_test(game->strategy_bits, i);
+        double utility;
+        int best_strategy = best_response(game, i, &utility);
 
         if (best_strategy != curr_strategy)
         {
-            game->strategies[i] = best_strategy;
+            game_set_strategy(game, i, best_strategy);
             change_occurred = 1;
-            LOG_NODE_UPDATE(i, curr_strategy, best_strategy,
-                           (best_strategy == 1) ? u_in : u_out);
+            LOG_NODE_UPDATE(graph_order_original(game->order, i), curr_strategy, best_strategy, utility);
         }
     }
 
     return change_occurred;
 }
 
+/*
+ * Event-driven BRD: a node's best response only depends on its neighbours,
+ * so after a flip only the neighbours need to be re-examined. The worklist
+ * is a ring buffer holding every node at most once; when it drains, every
+ * node is playing a best response, i.e. the profile is a pure Nash
+ * equilibrium. One "iteration" is one round over the nodes that were dirty
+ * when the round started.
+ */
+int run_best_response_worklist(game_system *game, int max_it, int verbose)
+{
+    int n = game->num_players;
+    int *queue = (int *)malloc(n * sizeof(int));
+    unsigned char *in_queue = (unsigned char *)malloc(n * sizeof(unsigned char));
+
+    if (n > 0 && (!queue || !in_queue))
+    {
+        fprintf(stderr, "Error: Memory allocation failed in run_best_response_worklist\n");
+        free(queue);
+        free(in_queue);
+        return -1;
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        queue[i] = i;
+        in_queue[i] = 1;
+    }
+
+    int head = 0;
+    int pending = n;
+
+    while (pending > 0 && game->iteration < max_it)
+    {
+        if (verbose && game->iteration % 100 == 0)
+        {
+            printf("[INFO] Iteration %d (%d dirty nodes)\n", game->iteration + 1, pending);
+        }
+
+        LOG_STEP_BEGIN(game->iteration, "BRD_WORKLIST");
+
+        int round = pending;
+        while (round-- > 0)
+        {
+            int i = queue[head];
+            head = (head + 1) % n;
+            pending--;
+            in_queue[i] = 0;
+
+            int curr_strategy = bitset_test(game->strategy_bits, i);
+            double utility;
+            int best_strategy = best_response(game, i, &utility);
+
+            if (best_strategy == curr_strategy)
+                continue;
+
+            game_set_strategy(game, i, best_strategy);
+            LOG_NODE_UPDATE(graph_order_original(game->order, i), curr_strategy, best_strategy, utility);
+
+            for (eidx_t k = game->g->row_ptr[i]; k < game->g->row_ptr[i + 1]; ++k)
+            {
+                int v = game->g->col_ind[k];
+                if (!in_queue[v])
+                {
+                    queue[(head + pending) % n] = v;
+                    pending++;
+                    in_queue[v] = 1;
+                }
+            }
+        }
+
+        LOG_STEP_END();
+        game->iteration++;
+    }
+
+    int converged = (pending == 0);
+    if (converged && verbose)
+        printf("[OK] Convergence reached at iteration %d (worklist empty)\n", game->iteration);
+
+    free(queue);
+    free(in_queue);
+    return converged ? (int)game->iteration : -1;
+}
+
 void init_regret_system(game_system *game)
 {
-    game->rs.regrets = (double *)calloc(game->num_players * 2, sizeof(double));
-    game->rs.probs = (double *)calloc(game->num_players * 2, sizeof(double));
+    int n = game->num_players;
+
+    game->rs.regret_out = (double *)calloc(n, sizeof(double));
+    game->rs.regret_in = (double *)calloc(n, sizeof(double));
+    game->rs.prob_in = (double *)malloc(n * sizeof(double));
+    game->rs.samples = (unsigned char *)malloc(n * sizeof(unsigned char));
+    game->rs.seed = rng_stream_key(RNG_STREAM_REGRET, 0);
+    game->rs.round = 0;
 
-    for (int i = 0; i < game->num_players * 2; ++i)
+    for (int i = 0; i < n; ++i)
     {
-        game->rs.probs[i] = 0.5;
+        game->rs.prob_in[i] = 0.5;
     }
 }
 
 void free_regret_system(game_system *game)
 {
-    free(game->rs.regrets);
-    free(game->rs.probs);
+    free(game->rs.regret_out);
+    free(game->rs.regret_in);
+    free(game->rs.prob_in);
+    free(game->rs.samples);
 }
 
-int run_regret_matching_iteration(game_system *game)
+/*
+ * RM kernels on the structure-of-arrays state. Both loops are branch-free
+ * over contiguous arrays so the compiler can vectorise them; the draw for
+ * node i in a round comes from the counter-based generator (31 bits, so the
+ * int-to-double conversion has a SIMD form), which makes the serial and the
+ * parallel engine produce the same samples.
+ */
+void regret_matching_sample(game_system *game, uint64_t round_key, int begin, int end)
 {
-    int nnodes = game->num_players;
+    const double *prob_in = game->rs.prob_in;
+    unsigned char *samples = game->rs.samples;
 
-    for (int i = 0; i < nnodes; ++i)
+    for (int i = begin; i < end; ++i)
     {
-        double prob_1 = game->rs.probs[2 * i + 1];
-        int old_s = game->strategies[i];
-        game->strategies[i] = (get_random_double() < prob_1) ? 1 : 0;
-        if (game->strategies[i] != old_s) {
-            LOG_NODE_UPDATE(i, old_s, game->strategies[i], 0.0);
-        }
+        int32_t draw = (int32_t)(rng_counter(round_key, (uint64_t)graph_order_original(game->order, i)) >> 33);
+        samples[i] = (double)draw < prob_in[i] * 2147483648.0;
     }
+}
 
-    int is_nash = 1;
-
-    for (int i = 0; i < nnodes; ++i)
+int regret_matching_update(game_system *game, int begin, int end)
+{
+    const int *unsecured = game->unsecured_neighbors;
+    const uint64_t *strategies = game->strategy_bits;
+    double *regret_out = game->rs.regret_out;
+    double *regret_in = game->rs.regret_in;
+    double *prob_in = game->rs.prob_in;
+    int regretful = 0;
+
+    for (int i = begin; i < end; ++i)
     {
-        double u0 = calculate_utility(game, i, 0);
-        double u1 = calculate_utility(game, i, 1);
-        double u_real = (game->strategies[i] == 1) ? u1 : u0;
+        double u0 = -PENALTY_UNSECURED * unsecured[i];
+        double u1 = -COST_SECURITY;
+        double u_real = bitset_test(strategies, i) ? u1 : u0;
 
         double r0 = u0 - u_real;
         double r1 = u1 - u_real;
+        regretful |= (r0 > 1e-9) | (r1 > 1e-9);
 
-        if (r0 > 1e-9 || r1 > 1e-9)
-        {
-            is_nash = 0;
-        }
-
-        game->rs.regrets[2 * i] += r0;
-        game->rs.regrets[2 * i + 1] += r1;
+        double acc_out = regret_out[i] + r0;
+        double acc_in = regret_in[i] + r1;
+        regret_out[i] = acc_out;
+        regret_in[i] = acc_in;
 
-        double r0_pos = (game->rs.regrets[2 * i] > 0) ? game->rs.regrets[2 * i] : 0.0;
-        double r1_pos = (game->rs.regrets[2 * i + 1] > 0) ? game->rs.regrets[2 * i + 1] : 0.0;
+        double r0_pos = acc_out > 0 ? acc_out : 0.0;
+        double r1_pos = acc_in > 0 ? acc_in : 0.0;
         double sum = r0_pos + r1_pos;
+        double p_in = r1_pos / (sum > 1e-9 ? sum : 1.0);
 
-        if (sum > 1e-9)
-        {
-            game->rs.probs[2 * i] = r0_pos / sum;
-            game->rs.probs[2 * i + 1] = r1_pos / sum;
-        }
-        else
+        prob_in[i] = (sum > 1e-9) ? p_in : 0.5;
+    }
+
+    return regretful;
+}
+
+int run_regret_matching_iteration(game_system *game)
+{
+    if (parallel_num_threads() > 1)
+        return run_regret_matching_iteration_parallel(game);
+
+    int nnodes = game->num_players;
+    uint64_t round_key = rng_mix64(game->rs.seed + (uint64_t)game->rs.round++);
+
+    regret_matching_sample(game, round_key, 0, nnodes);
+
+    for (int i = 0; i < nnodes; ++i)
+    {
+        int old_s = bitset_test(game->strategy_bits, i);
+        if (game->rs.samples[i] != old_s)
         {
-            game->rs.probs[2 * i] = 0.5;
-            game->rs.probs[2 * i + 1] = 0.5;
+            game_set_strategy(game, i, game->rs.samples[i]);
+            LOG_NODE_UPDATE(graph_order_original(game->order, i), old_s, bitset_test(game->strategy_bits, i), 0.0);
         }
     }
 
-    return !is_nash;
-
+    return regret_matching_update(game, 0, nnodes);
 }
 
 
@@ -137,25 +248,29 @@ void reset_fictitious_system(game_system *game)
 
     game->fs.turn = 100;
 
-
+    uint64_t key = rng_stream_key(RNG_STREAM_FICTITIOUS, (uint64_t)game->iteration);
 
     for (int i = 0; i < game->num_players; ++i)
     {
+        uint64_t r = rng_counter(key, (uint64_t)graph_order_original(game->order, i));
 
-        int variance = rand() % 11;
+        int variance = (int)((r & 0xFFFFFFFFULL) % 11);
 
         game->fs.counts[i] = 90 + variance;
 
         game->fs.believes[i] = (double)game->fs.counts[i] / (double)game->fs.turn;
 
-        game->strategies[i] = (rand() % 2);
+        game_set_strategy(game, i, (unsigned char)(r >> 63));
     }
 }
 
 void init_fictitious_system(game_system *game)
 {
     game->fs.counts = (int *)calloc(game->num_players, sizeof(int));
-    game->fs.believes = (double *)calloc(game->num_players, sizeof(double));
+    game->fs.believes = (double *)calloc((size_t)game->num_players + 1, sizeof(double));
+    game->fs.next_strategies = (unsigned char *)malloc(game->num_players * sizeof(unsigned char));
+    game->fs.deterministic = 0;
+    game->fs.believes[game->num_players] = 1.0;
 
     reset_fictitious_system(game);
 }
@@ -164,10 +279,13 @@ void free_fictitious_system(game_system *game)
 {
     free(game->fs.counts);
     free(game->fs.believes);
+    free(game->fs.next_strategies);
 }
 
 int run_fictitious_play_iteration(game_system *game)
 {
+    if (parallel_num_threads() > 1 || game->sell)
+        return run_fictitious_play_iteration_parallel(game);
 
     int n = game->num_players;
 
@@ -178,7 +296,7 @@ int run_fictitious_play_iteration(game_system *game)
     }
 
     int change_occurred = 0;
-    unsigned char *next_strategies = malloc(n * sizeof(unsigned char));
+    unsigned char *next_strategies = game->fs.next_strategies;
 
     for (int i = 0; i < n; ++i)
     {
@@ -187,10 +305,10 @@ int run_fictitious_play_iteration(game_system *game)
 
         double eu_0 = 0.0;
 
-        int start = game->g->row_ptr[i];
-        int end = game->g->row_ptr[i + 1];
+        eidx_t start = game->g->row_ptr[i];
+        eidx_t end = game->g->row_ptr[i + 1];
 
-        for (int k = start; k < end; ++k)
+        for (eidx_t k = start; k < end; ++k)
         {
             int neighbor = game->g->col_ind[k];
 
@@ -207,7 +325,7 @@ int run_fictitious_play_iteration(game_system *game)
             next_strategies[i] = 0;
         }
 
-        if (next_strategies[i] != game->strategies[i])
+        if (next_strategies[i] != bitset_test(game->strategy_bits, i))
         {
             change_occurred = 1;
         }
@@ -215,38 +333,40 @@ int run_fictitious_play_iteration(game_system *game)
 
     for (int i = 0; i < n; ++i)
     {
-        int old_s = game->strategies[i];
-        game->strategies[i] = next_strategies[i];
-        if (game->strategies[i] != old_s) {
-            LOG_NODE_UPDATE(i, old_s, game->strategies[i], 0.0);
+        int old_s = bitset_test(game->strategy_bits, i);
+        game_set_strategy(game, i, next_strategies[i]);
+        if (bitset_test(game->strategy_bits, i) != old_s) {
+            LOG_NODE_UPDATE(graph_order_original(game->order, i), old_s, bitset_test(game->strategy_bits, i), 0.0);
         }
 
-        if (game->strategies[i] == 1)
+        if (bitset_test(game->strategy_bits, i) == 1)
         {
             game->fs.counts[i]++;
         }
     }
     game->fs.turn++;
 
-    free(next_strategies);
     return change_occurred;
 }
 
 int run_async_fictitious_play_iteration(game_system *game)
 {
+    if (parallel_num_threads() > 1 || game->fs.deterministic || game->sell)
+        return run_async_fictitious_play_iteration_parallel(game);
+
     int n = game->num_players;
 
     int change_occurred = 0;
 
     for (int i = 0; i < n; i++)
     {
-        int old_strategy = game->strategies[i];
+        int old_strategy = bitset_test(game->strategy_bits, i);
 
         double expected_utility_0 = 0.0;
-        int start = game->g->row_ptr[i];
-        int end = game->g->row_ptr[i + 1];
+        eidx_t start = game->g->row_ptr[i];
+        eidx_t end = game->g->row_ptr[i + 1];
 
-        for (int m = start; m < end; ++m)
+        for (eidx_t m = start; m < end; ++m)
         {
             int neighbor_id = game->g->col_ind[m];
             double prob_neighbor_0 = 1.0 - game->fs.believes[neighbor_id];
@@ -255,16 +375,16 @@ int run_async_fictitious_play_iteration(game_system *game)
 
         double expected_utility_1 = -COST_SECURITY;
 
-        game->strategies[i] = (expected_utility_0 >= expected_utility_1) ? 0 : 1;
+        game_set_strategy(game, i, (expected_utility_0 >= expected_utility_1) ? 0 : 1);
 
-        if (game->strategies[i] != old_strategy)
+        if (bitset_test(game->strategy_bits, i) != old_strategy)
         {
             change_occurred = 1;
-            LOG_NODE_UPDATE(i, old_strategy, game->strategies[i], 0.0);
+            LOG_NODE_UPDATE(graph_order_original(game->order, i), old_strategy, bitset_test(game->strategy_bits, i), 0.0);
         }
 
-        game->fs.believes[i] = (game->fs.believes[i] * game->fs.turn + (game->strategies[i] == 1 ? 1.0 : 0.0)) / (game->fs.turn + 1);
-        if (game->strategies[i] == 1)
+        game->fs.believes[i] = (game->fs.believes[i] * game->fs.turn + (bitset_test(game->strategy_bits, i) == 1 ? 1.0 : 0.0)) / (game->fs.turn + 1);
+        if (bitset_test(game->strategy_bits, i) == 1)
         {
             game->fs.counts[i]++;
         }
@@ -278,73 +398,21 @@ int run_async_fictitious_play_iteration(game_system *game)
 
 int is_valid_cover(game_system *game)
 {
-    graph *g = game->g;
-    for (int u = 0; u < g->num_nodes; ++u)
-    {
-        if (game->strategies[u] == 1)
-            continue;
-
-        for (int k = g->row_ptr[u]; k < g->row_ptr[u + 1]; ++k)
-        {
-            int v = g->col_ind[k];
-            if (u > v)
-                continue;
-
-            if (game->strategies[v] == 0)
-            {
-
-                return 0;
-            }
-        }
-    }
-    return 1;
+    return game->uncovered_edges == 0;
 }
 
 int is_minimal(game_system *game)
 {
-    graph *g = game->g;
-    int n = game->num_players;
-    unsigned char *has_private = (unsigned char *)calloc(n, sizeof(unsigned char));
-
-    if (!has_private)
-        return 0;
-
-    for (int u = 0; u < n; ++u)
-    {
-        for (int k = g->row_ptr[u]; k < g->row_ptr[u + 1]; ++k)
-        {
-            int v = g->col_ind[k];
-            if (u >= v)
-                continue;
-
-            unsigned char su = game->strategies[u];
-            unsigned char sv = game->strategies[v];
-
-            if (su && !sv)
-                has_private[u] = 1;
-            else if (!su && sv)
-                has_private[v] = 1;
-        }
-    }
-
-    int minimal = 1;
-    for (int i = 0; i < n; ++i)
-    {
-        if (game->strategies[i] == 1 && !has_private[i])
-        {
-            minimal = 0;
-            break;
-        }
-    }
-
-    free(has_private);
-    return minimal;
+    return game->redundant_secured == 0;
 }
 
 
 
 int run_simulation_with_restart(game_system *game, int algorithm, int max_it, int verbose, int restart_interval)
 {
+    if (algorithm == ALGO_BRD_WORKLIST)
+        return run_best_response_worklist(game, max_it, verbose);
+
     int converged = 0;
     int no_change_streak = 0;
     int last_restart_it = 0;
@@ -373,6 +441,7 @@ int run_simulation_with_restart(game_system *game, int algorithm, int max_it, in
         else if (algorithm == ALGO_RM) algo_name = "RM";
         else if (algorithm == ALGO_FP) algo_name = "FP";
         else if (algorithm == ALGO_FP_ASYNC) algo_name = "FP_ASYNC";
+        else if (algorithm == ALGO_BRD_COLORED) algo_name = "BRD_COLORED";
         (void)algo_name;
 
 
@@ -396,6 +465,10 @@ int run_simulation_with_restart(game_system *game, int algorithm, int max_it, in
         {
             change = run_async_fictitious_play_iteration(game);
         }
+        else if (algorithm == ALGO_BRD_COLORED)
+        {
+            change = run_best_response_colored_iteration(game);
+        }
 
         LOG_STEP_END();
 
@@ -0,0 +1,519 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "../include/strategic_game.h"
+#include "../include/graph_coloring.h"
+#include "../include/sell_matrix.h"
+#include "../include/bitset.h"
+#include "../include/parallel.h"
+#include "../include/rng.h"
+
+/*
+ * Multi-threaded engines for the strategic game, built on the worker pool
+ * in parallel.c. Per-node logging is not emitted from worker threads.
+ */
+
+typedef struct
+{
+    game_system *game;
+    const int *nodes;
+    long count;
+    int changed;
+} brd_class_task;
+
+static void brd_class_worker(int thread_id, int num_threads, void *arg)
+{
+    brd_class_task *t = (brd_class_task *)arg;
+    game_system *game = t->game;
+    game_counter_delta delta = {0, 0};
+    int changed = 0;
+
+    long begin, end;
+    parallel_block(t->count, thread_id, num_threads, &begin, &end);
+
+    for (long idx = begin; idx < end; ++idx)
+    {
+        int i = t->nodes[idx];
+        int curr_strategy = bitset_test_relaxed(game->strategy_bits, i);
+        double u_out = calculate_utility(game, i, 0);
+        double u_in = calculate_utility(game, i, 1);
+
+        int best_strategy = curr_strategy;
+        if (u_in > u_out)
+            best_strategy = 1;
+        else if (u_out > u_in)
+            best_strategy = 0;
+
+        if (best_strategy != curr_strategy)
+        {
+            game_set_strategy_concurrent(game, i, best_strategy, &delta);
+            changed = 1;
+        }
+    }
+
+    __atomic_fetch_add(&game->uncovered_edges, delta.uncovered_edges, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&game->redundant_secured, delta.redundant_secured, __ATOMIC_RELAXED);
+    if (changed)
+        __atomic_store_n(&t->changed, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * One BRD sweep, colour class by colour class. Nodes of a class are
+ * pairwise non-adjacent, so their best responses are independent and the
+ * sweep is equivalent to a sequential sweep in colour order, whatever the
+ * number of threads.
+ */
+int run_best_response_colored_iteration(game_system *game)
+{
+    if (!game->coloring)
+    {
+        game->coloring = compute_graph_coloring(game->g);
+        if (!game->coloring)
+        {
+            fprintf(stderr, "Error: Graph colouring failed, falling back to sequential BRD\n");
+            return run_best_response_iteration(game);
+        }
+    }
+
+    graph_coloring *c = game->coloring;
+    int change_occurred = 0;
+
+    for (int color = 0; color < c->num_colors; ++color)
+    {
+        brd_class_task t;
+        t.game = game;
+        t.nodes = c->class_nodes + c->class_ptr[color];
+        t.count = c->class_ptr[color + 1] - c->class_ptr[color];
+        t.changed = 0;
+
+        parallel_run(brd_class_worker, &t);
+
+        if (t.changed)
+            change_occurred = 1;
+    }
+
+    return change_occurred;
+}
+
+
+static int *edge_partition(game_system *game)
+{
+    int num_threads = parallel_num_threads();
+
+    if (game->partition && game->num_parts == num_threads)
+        return game->partition;
+
+    free(game->partition);
+    game->partition = (int *)malloc((num_threads + 1) * sizeof(int));
+    if (!game->partition)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in edge_partition\n");
+        exit(1);
+    }
+
+    parallel_partition_by_edges(game->g, num_threads, game->partition);
+    game->num_parts = num_threads;
+    return game->partition;
+}
+
+/*
+ * Flips a node's strategy without touching the global counters. Safe for
+ * arbitrary (also adjacent) concurrent flips because neighbour counters are
+ * only ever changed by atomic +-1; the globals are recounted afterwards by
+ * recount_global_counters().
+ */
+static void flip_strategy_unordered(game_system *game, int player_id, unsigned char strategy)
+{
+    bitset_assign_atomic(game->strategy_bits, player_id, strategy);
+
+    int step = (strategy == 1) ? -1 : 1;
+    graph *g = game->g;
+    for (eidx_t k = g->row_ptr[player_id]; k < g->row_ptr[player_id + 1]; ++k)
+    {
+        __atomic_fetch_add(&game->unsecured_neighbors[g->col_ind[k]], step, __ATOMIC_RELAXED);
+    }
+}
+
+typedef struct
+{
+    game_system *game;
+    const int *bounds;
+    int changed;
+} fp_task;
+
+static void recount_worker(int thread_id, int num_threads, void *arg)
+{
+    fp_task *t = (fp_task *)arg;
+    game_system *game = t->game;
+    (void)num_threads;
+
+    long uncovered = 0;
+    int redundant = 0;
+
+    for (int i = t->bounds[thread_id]; i < t->bounds[thread_id + 1]; ++i)
+    {
+        int unsecured = game->unsecured_neighbors[i];
+        if (!bitset_test(game->strategy_bits, i))
+            uncovered += unsecured;
+        else if (unsecured == 0)
+            redundant++;
+    }
+
+    __atomic_fetch_add(&game->uncovered_edges, uncovered, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&game->redundant_secured, redundant, __ATOMIC_RELAXED);
+}
+
+static void recount_global_counters(game_system *game, const int *bounds)
+{
+    fp_task t = {game, bounds, 0};
+
+    game->uncovered_edges = 0;
+    game->redundant_secured = 0;
+    parallel_run(recount_worker, &t);
+    game->uncovered_edges /= 2;
+}
+
+static void fp_decide_worker(int thread_id, int num_threads, void *arg)
+{
+    fp_task *t = (fp_task *)arg;
+    game_system *game = t->game;
+    graph *g = game->g;
+    const double *believes = game->fs.believes;
+    unsigned char *next_strategies = game->fs.next_strategies;
+    int changed = 0;
+    (void)num_threads;
+
+    for (int i = t->bounds[thread_id]; i < t->bounds[thread_id + 1]; ++i)
+    {
+        double eu_1 = -COST_SECURITY;
+        double eu_0 = 0.0;
+
+        for (eidx_t k = g->row_ptr[i]; k < g->row_ptr[i + 1]; ++k)
+        {
+            double prob_neighbor_0 = 1.0 - believes[g->col_ind[k]];
+            eu_0 -= PENALTY_UNSECURED * prob_neighbor_0;
+        }
+
+        next_strategies[i] = (eu_1 > eu_0) ? 1 : 0;
+        if (next_strategies[i] != bitset_test(game->strategy_bits, i))
+            changed = 1;
+    }
+
+    if (changed)
+        __atomic_store_n(&t->changed, 1, __ATOMIC_RELAXED);
+}
+
+/* Same decision from the SELL-C-sigma copy: one chunk of rows at a time. */
+static void fp_decide_sell_worker(int thread_id, int num_threads, void *arg)
+{
+    fp_task *t = (fp_task *)arg;
+    game_system *game = t->game;
+    const sell_matrix *sell = game->sell;
+    unsigned char *next_strategies = game->fs.next_strategies;
+    double *eu_0 = (double *)malloc((size_t)sell->chunk_size * sizeof(double));
+    int changed = 0;
+    int begin, end;
+
+    if (!eu_0)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in fp_decide_sell_worker\n");
+        exit(1);
+    }
+
+    sell_partition(sell, thread_id, num_threads, &begin, &end);
+    for (int chunk = begin; chunk < end; ++chunk)
+    {
+        sell_unsecured_penalty(sell, chunk, game->fs.believes, eu_0);
+        for (int lane = 0; lane < sell->chunk_size; ++lane)
+        {
+            int i = sell->perm[(long)chunk * sell->chunk_size + lane];
+            if (i < 0)
+                continue;
+
+            next_strategies[i] = (-COST_SECURITY > eu_0[lane]) ? 1 : 0;
+            if (next_strategies[i] != bitset_test(game->strategy_bits, i))
+                changed = 1;
+        }
+    }
+
+    free(eu_0);
+    if (changed)
+        __atomic_store_n(&t->changed, 1, __ATOMIC_RELAXED);
+}
+
+static void fp_commit_worker(int thread_id, int num_threads, void *arg)
+{
+    fp_task *t = (fp_task *)arg;
+    game_system *game = t->game;
+    fictitious_system *fs = &game->fs;
+    double next_turn = (double)(fs->turn + 1);
+    (void)num_threads;
+
+    for (int i = t->bounds[thread_id]; i < t->bounds[thread_id + 1]; ++i)
+    {
+        unsigned char s = fs->next_strategies[i];
+        if (s != bitset_test_relaxed(game->strategy_bits, i))
+            flip_strategy_unordered(game, i, s);
+
+        if (s == 1)
+            fs->counts[i]++;
+        fs->believes[i] = (double)fs->counts[i] / next_turn;
+    }
+}
+
+/*
+ * Synchronous FP on the worker pool. The decide pass reads the beliefs of
+ * turn t and fills the persistent next_strategies buffer; the commit pass
+ * then publishes strategies, counts and the beliefs of turn t + 1. Each
+ * node is owned by one thread of an edge-balanced partition and performs
+ * exactly the serial arithmetic, so results are bit-identical to
+ * run_fictitious_play_iteration() for any number of threads, and with or
+ * without the SELL-C-sigma layout. Beliefs must
+ * equal counts / turn on entry, which reset_fictitious_system() ensures.
+ */
+int run_fictitious_play_iteration_parallel(game_system *game)
+{
+    fp_task t;
+    t.game = game;
+    t.bounds = edge_partition(game);
+    t.changed = 0;
+
+    parallel_run(game->sell ? fp_decide_sell_worker : fp_decide_worker, &t);
+    parallel_run(fp_commit_worker, &t);
+    if (t.changed)
+        recount_global_counters(game, t.bounds);
+
+    game->fs.turn++;
+    return t.changed;
+}
+
+
+static double load_belief(const double *believes, int node)
+{
+    double value;
+    __atomic_load(&believes[node], &value, __ATOMIC_RELAXED);
+    return value;
+}
+
+static void store_belief(double *believes, int node, double value)
+{
+    __atomic_store(&believes[node], &value, __ATOMIC_RELAXED);
+}
+
+static int async_fp_update(game_system *game, int i, double expected_utility_0)
+{
+    fictitious_system *fs = &game->fs;
+    int old_strategy = bitset_test_relaxed(game->strategy_bits, i);
+    double expected_utility_1 = -COST_SECURITY;
+    unsigned char s = (expected_utility_0 >= expected_utility_1) ? 0 : 1;
+
+    if (s != old_strategy)
+        flip_strategy_unordered(game, i, s);
+
+    double belief = (fs->believes[i] * fs->turn + (s == 1 ? 1.0 : 0.0)) / (fs->turn + 1);
+    store_belief(fs->believes, i, belief);
+    if (s == 1)
+        fs->counts[i]++;
+
+    return s != old_strategy;
+}
+
+/*
+ * Hogwild: every thread sweeps its own block in order and reads neighbour
+ * beliefs with relaxed atomic loads, seeing whatever other threads have
+ * published so far. Within a block this is exactly the serial async update.
+ */
+static void async_fp_hogwild_worker(int thread_id, int num_threads, void *arg)
+{
+    fp_task *t = (fp_task *)arg;
+    game_system *game = t->game;
+    graph *g = game->g;
+    int changed = 0;
+    (void)num_threads;
+
+    for (int i = t->bounds[thread_id]; i < t->bounds[thread_id + 1]; ++i)
+    {
+        double expected_utility_0 = 0.0;
+        for (eidx_t m = g->row_ptr[i]; m < g->row_ptr[i + 1]; ++m)
+        {
+            double prob_neighbor_0 = 1.0 - load_belief(game->fs.believes, g->col_ind[m]);
+            expected_utility_0 += prob_neighbor_0 * (-PENALTY_UNSECURED);
+        }
+
+        changed |= async_fp_update(game, i, expected_utility_0);
+    }
+
+    if (changed)
+        __atomic_store_n(&t->changed, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Hogwild over the SELL-C-sigma copy: each thread walks its chunks in
+ * order, computes the expected utilities of a whole chunk from the beliefs
+ * it sees, then updates those rows one by one. Rows of one chunk therefore
+ * do not see each other's updates of the same sweep. The vector gathers
+ * use plain loads; aligned 8-byte loads do not tear on the supported
+ * targets, and stale values are already part of the hogwild contract.
+ */
+static void async_fp_sell_worker(int thread_id, int num_threads, void *arg)
+{
+    fp_task *t = (fp_task *)arg;
+    game_system *game = t->game;
+    const sell_matrix *sell = game->sell;
+    double *eu_0 = (double *)malloc((size_t)sell->chunk_size * sizeof(double));
+    int changed = 0;
+    int begin, end;
+
+    if (!eu_0)
+    {
+        fprintf(stderr, "Error: Memory allocation failed in async_fp_sell_worker\n");
+        exit(1);
+    }
+
+    sell_partition(sell, thread_id, num_threads, &begin, &end);
+    for (int chunk = begin; chunk < end; ++chunk)
+    {
+        sell_unsecured_penalty(sell, chunk, game->fs.believes, eu_0);
+        for (int lane = 0; lane < sell->chunk_size; ++lane)
+        {
+            int i = sell->perm[(long)chunk * sell->chunk_size + lane];
+            if (i >= 0)
+                changed |= async_fp_update(game, i, eu_0[lane]);
+        }
+    }
+
+    free(eu_0);
+    if (changed)
+        __atomic_store_n(&t->changed, 1, __ATOMIC_RELAXED);
+}
+
+typedef struct
+{
+    game_system *game;
+    graph_coloring *coloring;
+    int changed;
+} async_fp_color_task;
+
+/*
+ * Deterministic variant: the epochs are the colour classes of the graph,
+ * separated by barriers, and each thread owns a fixed slice of every class.
+ * Nodes of one class are pairwise non-adjacent, so nobody writes a belief
+ * that is being read in the same epoch and the sweep equals the serial
+ * async update in colour order, independently of the thread count.
+ */
+static void async_fp_color_worker(int thread_id, int num_threads, void *arg)
+{
+    async_fp_color_task *t = (async_fp_color_task *)arg;
+    game_system *game = t->game;
+    graph *g = game->g;
+    graph_coloring *c = t->coloring;
+    int changed = 0;
+
+    for (int color = 0; color < c->num_colors; ++color)
+    {
+        long begin, end;
+        parallel_block(c->class_ptr[color + 1] - c->class_ptr[color], thread_id, num_threads, &begin, &end);
+        const int *nodes = c->class_nodes + c->class_ptr[color];
+
+        for (long idx = begin; idx < end; ++idx)
+        {
+            int i = nodes[idx];
+            double expected_utility_0 = 0.0;
+            for (eidx_t m = g->row_ptr[i]; m < g->row_ptr[i + 1]; ++m)
+            {
+                double prob_neighbor_0 = 1.0 - game->fs.believes[g->col_ind[m]];
+                expected_utility_0 += prob_neighbor_0 * (-PENALTY_UNSECURED);
+            }
+
+            changed |= async_fp_update(game, i, expected_utility_0);
+        }
+
+        parallel_barrier();
+    }
+
+    if (changed)
+        __atomic_store_n(&t->changed, 1, __ATOMIC_RELAXED);
+}
+
+int run_async_fictitious_play_iteration_parallel(game_system *game)
+{
+    fp_task t;
+    t.game = game;
+    t.bounds = edge_partition(game);
+    t.changed = 0;
+
+    if (game->fs.deterministic && !game->coloring)
+        game->coloring = compute_graph_coloring(game->g);
+
+    if (game->fs.deterministic && game->coloring)
+    {
+        async_fp_color_task ct = {game, game->coloring, 0};
+        parallel_run(async_fp_color_worker, &ct);
+        t.changed = ct.changed;
+    }
+    else
+    {
+        parallel_run(game->sell ? async_fp_sell_worker : async_fp_hogwild_worker, &t);
+    }
+
+    if (t.changed)
+        recount_global_counters(game, t.bounds);
+
+    game->fs.turn++;
+    return t.changed;
+}
+
+
+typedef struct
+{
+    game_system *game;
+    const int *bounds;
+    uint64_t round_key;
+    int regretful;
+} rm_task;
+
+static void rm_sample_worker(int thread_id, int num_threads, void *arg)
+{
+    rm_task *t = (rm_task *)arg;
+    game_system *game = t->game;
+    int begin = t->bounds[thread_id];
+    int end = t->bounds[thread_id + 1];
+    (void)num_threads;
+
+    regret_matching_sample(game, t->round_key, begin, end);
+
+    for (int i = begin; i < end; ++i)
+    {
+        if (game->rs.samples[i] != bitset_test_relaxed(game->strategy_bits, i))
+            flip_strategy_unordered(game, i, game->rs.samples[i]);
+    }
+}
+
+static void rm_update_worker(int thread_id, int num_threads, void *arg)
+{
+    rm_task *t = (rm_task *)arg;
+    (void)num_threads;
+
+    if (regret_matching_update(t->game, t->bounds[thread_id], t->bounds[thread_id + 1]))
+        __atomic_store_n(&t->regretful, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Regret Matching on the worker pool: sample and flip, then (after the
+ * pass barrier, once all neighbour counters are final) update regrets.
+ * Draws come from the counter-based generator keyed by round and node, so
+ * the trajectory is identical to the serial engine for any thread count.
+ */
+int run_regret_matching_iteration_parallel(game_system *game)
+{
+    rm_task t;
+    t.game = game;
+    t.bounds = edge_partition(game);
+    t.round_key = rng_mix64(game->rs.seed + (uint64_t)game->rs.round++);
+    t.regretful = 0;
+
+    parallel_run(rm_sample_worker, &t);
+    recount_global_counters(game, t.bounds);
+    parallel_run(rm_update_worker, &t);
+
+    return t.regretful;
+}